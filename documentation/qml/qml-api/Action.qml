@@ -168,6 +168,69 @@ Item {
      */
     property Type parameterType : None
 
+    /*!
+      \qmlproperty enumeration Action::activationPolicy : Action.Unrestricted
+      \since 1.1
+
+      How bursts of triggers are handled.
+
+      \list
+      \li Action.Unrestricted - every trigger goes through right away
+      \li Action.Debounce - the action is triggered with the last value once the
+          triggers stopped for \l activationInterval milliseconds
+      \li Action.Throttle - the action is triggered at most once every
+          \l activationInterval milliseconds, the triggers in between are queued
+          up to \l activationBacklog
+      \endlist
+
+      Protects the application from a client or a stuck key triggering the action
+      hundreds of times per second.
+     */
+    property int activationPolicy
+
+    /*!
+      \qmlproperty int Action::activationInterval : 100
+      \since 1.1
+
+      The quiet period of Action.Debounce and the minimum time between two
+      triggers with Action.Throttle, in milliseconds.
+     */
+    property int activationInterval : 100
+
+    /*!
+      \qmlproperty int Action::activationBacklog : 0
+      \since 1.1
+
+      The number of triggers a throttled action queues. With 0 the triggers
+      coming in too fast are dropped.
+     */
+    property int activationBacklog : 0
+
+    /*!
+      \qmlproperty enumeration Action::overflowPolicy : Action.DropNewest
+      \since 1.1
+
+      What a throttled action drops when its backlog is full:
+      the new trigger (Action.DropNewest) or the oldest queued one (Action.DropOldest).
+     */
+    property int overflowPolicy
+
+    /*!
+      \qmlproperty int Action::droppedActivations
+      \since 1.1
+
+      The number of triggers dropped by Action.Throttle. Read only.
+     */
+    readonly property int droppedActivations
+
+    /*!
+      \qmlproperty int Action::coalescedActivations
+      \since 1.1
+
+      The number of triggers merged into a later one by Action.Debounce. Read only.
+     */
+    readonly property int coalescedActivations
+
     /*!
      \qmlsignal Action::triggered(var value)
      The value is always compatible with the set parameterType.
@@ -175,6 +238,22 @@ Item {
     */
     signal triggered(var value)
 
+    /*!
+     \qmlsignal Action::triggeredNone()
+     \qmlsignal Action::triggeredString(string value)
+     \qmlsignal Action::triggeredInt(int value)
+     \qmlsignal Action::triggeredBool(bool value)
+     \qmlsignal Action::triggeredReal(real value)
+
+     Emitted together with triggered(). Only the signal matching the
+     parameterType is emitted.
+    */
+    signal triggeredNone()
+    signal triggeredString(string value)
+    signal triggeredInt(int value)
+    signal triggeredBool(bool value)
+    signal triggeredReal(real value)
+
     /*!
       \qmlmethod void Action::trigger(var value)
 
@@ -56,6 +56,20 @@ Item {
      */
     property list<ActionContext> localContexts
 
+    /*!
+      \qmlproperty bool ActionManager::deferredUpdates
+      \since 1.1
+
+      If true the manager reconciles the changes to its contexts and actions
+      once per event loop iteration instead of immediately.
+
+      A state change that modifies a large number of actions at once
+      then updates the exported actions and the HUD only once.
+
+      Setting the property to false reconciles the pending changes immediately.
+     */
+    property bool deferredUpdates
+
 
     /*!
      this is a shorthand for
@@ -94,4 +108,21 @@ Item {
     */
     function removeLocalContext(context) {}
 
+    /*!
+     Starts a batch of updates.
+
+     Until the matching endUpdate() is called the manager only records the
+     changes made to its contexts and actions. The changes are then reconciled
+     in a single pass which updates the exported actions and the HUD only once.
+
+     Calls to beginUpdate() and endUpdate() can be nested; the changes are
+     reconciled when the outermost endUpdate() is called.
+    */
+    function beginUpdate() {}
+
+    /*!
+     Ends a batch of updates started with beginUpdate().
+    */
+    function endUpdate() {}
+
 }
@@ -57,4 +57,43 @@ PreviewParameter {
      */
     property real value : 0
 
+    /*!
+     \qmlproperty enumeration PreviewRangeParameter::deliveryPolicy : PreviewRangeParameter.Immediate
+     \since 1.1
+
+     How the values coming from the HUD are delivered to \l value.
+
+     \list
+     \li PreviewRangeParameter.Immediate - every value is delivered as soon as it arrives
+     \li PreviewRangeParameter.Coalesced - only the latest value is delivered on the next
+         event loop iteration
+     \li PreviewRangeParameter.RateLimited - at most \l maximumRate values are delivered per second
+     \endlist
+
+     A slider drag in the HUD can send many more values than an expensive preview is
+     able to render. The pending value is always delivered before the preview action
+     is committed, cancelled, reset or ended.
+     */
+    property int deliveryPolicy
+
+    /*!
+     \qmlproperty int PreviewRangeParameter::maximumRate : 60
+     \since 1.1
+
+     The maximum number of values delivered per second when \l deliveryPolicy
+     is PreviewRangeParameter.RateLimited.
+     */
+    property int maximumRate : 60
+
+    /*!
+     \qmlproperty real PreviewRangeParameter::valueEpsilon : 0
+     \since 1.1
+
+     The smallest change of \l value that is sent back to the HUD.
+
+     The value is published to the HUD as the state of the parameter, so
+     setting it from the application moves the slider in the HUD as well.
+     */
+    property real valueEpsilon : 0
+
 }
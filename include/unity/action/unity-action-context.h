@@ -27,6 +27,7 @@ namespace action {
 #include <QObject>
 #include <QScopedPointer>
 #include <QSet>
+#include <QList>
 
 class Q_DECL_EXPORT unity::action::ActionContext : public QObject
 {
@@ -46,14 +47,32 @@ public:
     Q_INVOKABLE void addAction(unity::action::Action *action);
     Q_INVOKABLE void removeAction(unity::action::Action *action);
 
+    void addActions(const QList<unity::action::Action *> &actions);
+    void removeActions(const QList<unity::action::Action *> &actions);
+    void clear();
+
     bool active() const;
     void setActive(bool value);
 
     QSet<Action *> actions() const;
+    const QSet<Action *> &constActions() const;
+    bool contains(unity::action::Action *action) const;
+    int count() const;
+
+    template <typename Visitor>
+    void forEachAction(Visitor visitor) const {
+        const QSet<Action *> &set = constActions();
+        for (QSet<Action *>::const_iterator i = set.constBegin(); i != set.constEnd(); ++i)
+            visitor(*i);
+    }
+
+    quint64 generation() const;
 
 signals:
     void activeChanged(bool value);
     void actionsChanged();
+    void actionsAdded(const QList<unity::action::Action *> &actions);
+    void actionsRemoved(const QList<unity::action::Action *> &actions);
 
 private:
         class Private;
@@ -35,9 +35,33 @@ class Q_DECL_EXPORT unity::action::ActionManager : public QObject
 
     Q_PROPERTY(unity::action::ActionContext *globalContext
                READ globalContext)
+    Q_PROPERTY(bool deferredUpdates
+               READ deferredUpdates
+               WRITE setDeferredUpdates
+               NOTIFY deferredUpdatesChanged
+               REVISION 1)
 
 public:
 
+    enum Operation {
+        ActionOperation,
+        ContextSwitchOperation,
+        PropertyOperation,
+        ParameterOperation,
+        FlushOperation,
+        OperationCount
+    };
+
+    enum Counter {
+        ActionGroupInsert,
+        ActionGroupRemove,
+        EnabledChange,
+        AttributeSet,
+        DescriptionAdd,
+        StateChange,
+        CounterCount
+    };
+
     explicit ActionManager(QObject *parent = 0);
     virtual ~ActionManager();
 
@@ -50,14 +74,33 @@ public:
 
     Q_INVOKABLE void removeLocalContext(unity::action::ActionContext *context);
     QSet<ActionContext *> localContexts() const;
+    const QSet<ActionContext *> &constLocalContexts() const;
 
     QSet<Action *> actions() const;
+    const QSet<Action *> &constActions() const;
+    bool containsAction(unity::action::Action *action) const;
+    int actionCount() const;
+    quint64 generation() const;
+
+    Q_INVOKABLE void beginUpdate();
+    Q_INVOKABLE void endUpdate();
+
+    bool deferredUpdates() const;
+    void setDeferredUpdates(bool value);
+
+    int trafficCount(Operation operation, Counter counter) const;
+    void resetTrafficCounters();
+
+    static qint64 shutdownFlushTime();
 
 signals:
     void localContextsChanged();
     void actionsChanged();
 
     Q_REVISION(1) void quit();
+    Q_REVISION(1) void deferredUpdatesChanged(bool value);
+    Q_REVISION(1) void actionsAdded(const QList<unity::action::Action *> &actions);
+    Q_REVISION(1) void actionsRemoved(const QList<unity::action::Action *> &actions);
 
 private:
         class Private;
@@ -31,7 +31,7 @@ class Q_DECL_EXPORT unity::action::Action : public QObject
 {
     Q_OBJECT
     Q_DISABLE_COPY(Action)
-    Q_ENUMS(Type)
+    Q_ENUMS(Type ActivationPolicy OverflowPolicy)
 
     Q_PROPERTY(QString name
                READ name
@@ -61,6 +61,34 @@ class Q_DECL_EXPORT unity::action::Action : public QObject
                READ parameterType
                WRITE setParameterType
                NOTIFY parameterTypeChanged)
+    Q_PROPERTY(unity::action::Action::ActivationPolicy activationPolicy
+               READ activationPolicy
+               WRITE setActivationPolicy
+               NOTIFY activationPolicyChanged
+               REVISION 1)
+    Q_PROPERTY(int activationInterval
+               READ activationInterval
+               WRITE setActivationInterval
+               NOTIFY activationIntervalChanged
+               REVISION 1)
+    Q_PROPERTY(int activationBacklog
+               READ activationBacklog
+               WRITE setActivationBacklog
+               NOTIFY activationBacklogChanged
+               REVISION 1)
+    Q_PROPERTY(unity::action::Action::OverflowPolicy overflowPolicy
+               READ overflowPolicy
+               WRITE setOverflowPolicy
+               NOTIFY overflowPolicyChanged
+               REVISION 1)
+    Q_PROPERTY(int droppedActivations
+               READ droppedActivations
+               NOTIFY activationCountersChanged
+               REVISION 1)
+    Q_PROPERTY(int coalescedActivations
+               READ coalescedActivations
+               NOTIFY activationCountersChanged
+               REVISION 1)
 
 public:
 
@@ -72,6 +100,30 @@ public:
         Real
     };
 
+    enum ActivationPolicy {
+        Unrestricted,
+        Debounce,
+        Throttle
+    };
+
+    enum OverflowPolicy {
+        DropNewest,
+        DropOldest
+    };
+
+    enum ChangeFlag {
+        NameChange          = 0x001,
+        TextChange          = 0x002,
+        IconNameChange      = 0x004,
+        DescriptionChange   = 0x008,
+        KeywordsChange      = 0x010,
+        EnabledChange       = 0x020,
+        ParameterTypeChange = 0x040,
+        CommitLabelChange   = 0x080,
+        ParametersChange    = 0x100
+    };
+    Q_DECLARE_FLAGS(ChangeMask, ChangeFlag)
+
     explicit Action(QObject *parent = 0);
     virtual ~Action();
 
@@ -96,8 +148,32 @@ public:
     Type parameterType() const;
     void setParameterType(Type value);
 
+    ActivationPolicy activationPolicy() const;
+    void setActivationPolicy(ActivationPolicy value);
+
+    int activationInterval() const;
+    void setActivationInterval(int value);
+
+    int activationBacklog() const;
+    void setActivationBacklog(int value);
+
+    OverflowPolicy overflowPolicy() const;
+    void setOverflowPolicy(OverflowPolicy value);
+
+    int droppedActivations() const;
+    int coalescedActivations() const;
+    void resetActivationCounters();
+
 public slots:
     void trigger(QVariant value = QVariant());
+    void triggerNone();
+    void triggerString(const QString &value);
+    void triggerInt(int value);
+    void triggerBool(bool value);
+    void triggerReal(double value);
+
+public:
+    void postTrigger(const QVariant &value = QVariant());
 
 signals:
     void nameChanged(const QString &value);
@@ -107,12 +183,35 @@ signals:
     void keywordsChanged(const QString &value);
     void enabledChanged(bool value);
     void parameterTypeChanged(unity::action::Action::Type value);
+    void propertiesChanged(unity::action::Action::ChangeMask changes);
 
     void triggered(QVariant value);
+    void triggeredNone();
+    void triggeredString(const QString &value);
+    void triggeredInt(int value);
+    void triggeredBool(bool value);
+    void triggeredReal(double value);
+
+    Q_REVISION(1) void activationPolicyChanged(unity::action::Action::ActivationPolicy value);
+    Q_REVISION(1) void activationIntervalChanged(int value);
+    Q_REVISION(1) void activationBacklogChanged(int value);
+    Q_REVISION(1) void overflowPolicyChanged(unity::action::Action::OverflowPolicy value);
+    Q_REVISION(1) void activationCountersChanged();
+
+protected:
+    bool event(QEvent *event);
 
 private:
+    void emitTyped(const QVariant &value);
+    bool admitActivation(const QVariant &value);
+    void flushActivations();
+
     class Private;
     QScopedPointer<Private> d;
 };
+Q_DECLARE_OPERATORS_FOR_FLAGS(unity::action::Action::ChangeMask)
 Q_DECLARE_METATYPE(unity::action::Action::Type)
+Q_DECLARE_METATYPE(unity::action::Action::ChangeMask)
+Q_DECLARE_METATYPE(unity::action::Action::ActivationPolicy)
+Q_DECLARE_METATYPE(unity::action::Action::OverflowPolicy)
 #endif
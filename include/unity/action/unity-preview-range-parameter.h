@@ -29,6 +29,7 @@ class Q_DECL_EXPORT unity::action::PreviewRangeParameter : public unity::action:
 {
     Q_OBJECT
     Q_DISABLE_COPY(PreviewRangeParameter)
+    Q_ENUMS(DeliveryPolicy)
     Q_PROPERTY(QString text
                READ text
                WRITE setText
@@ -45,9 +46,30 @@ class Q_DECL_EXPORT unity::action::PreviewRangeParameter : public unity::action:
                READ maximumValue
                WRITE setMaximumValue
                NOTIFY maximumValueChanged)
+    Q_PROPERTY(unity::action::PreviewRangeParameter::DeliveryPolicy deliveryPolicy
+               READ deliveryPolicy
+               WRITE setDeliveryPolicy
+               NOTIFY deliveryPolicyChanged
+               REVISION 1)
+    Q_PROPERTY(int maximumRate
+               READ maximumRate
+               WRITE setMaximumRate
+               NOTIFY maximumRateChanged
+               REVISION 1)
+    Q_PROPERTY(float valueEpsilon
+               READ valueEpsilon
+               WRITE setValueEpsilon
+               NOTIFY valueEpsilonChanged
+               REVISION 1)
 
 public:
 
+    enum DeliveryPolicy {
+        Immediate,
+        Coalesced,
+        RateLimited
+    };
+
     explicit PreviewRangeParameter(QObject *parent = 0);
     virtual ~PreviewRangeParameter();
 
@@ -63,11 +85,29 @@ public:
     float maximumValue() const;
     void setMaximumValue(float value);
 
+    DeliveryPolicy deliveryPolicy() const;
+    void setDeliveryPolicy(DeliveryPolicy value);
+
+    int maximumRate() const;
+    void setMaximumRate(int value);
+
+    float valueEpsilon() const;
+    void setValueEpsilon(float value);
+
+    void deliverValue(float value);
+    bool hasPendingValue() const;
+
+public slots:
+    void flushPendingValue();
+
 signals:
     void textChanged(const QString &text);
     void valueChanged(float value);
     void minimumValueChanged(float value);
     void maximumValueChanged(float value);
+    Q_REVISION(1) void deliveryPolicyChanged(unity::action::PreviewRangeParameter::DeliveryPolicy value);
+    Q_REVISION(1) void maximumRateChanged(int value);
+    Q_REVISION(1) void valueEpsilonChanged(float value);
 
 private:
     class Private;
@@ -33,6 +33,7 @@ UnityActionQmlPlugin::registerTypes(const char *uri)
     // @uri Ubuntu.Unity.Action
 
     qmlRegisterType<unity::action::Action>                     ();
+    qmlRegisterRevision<unity::action::Action, 1>              (uri, 1, 1);
     qmlRegisterType<unity::action::qml::Action>                (uri, 1, 0, "Action");
     qmlRegisterType<unity::action::qml::Action>                (uri, 1, 1, "Action");
     qmlRegisterType<unity::action::PreviewAction>              ();
@@ -41,7 +42,7 @@ UnityActionQmlPlugin::registerTypes(const char *uri)
 
     qmlRegisterType<unity::action::PreviewParameter>      ();
     qmlRegisterType<unity::action::PreviewRangeParameter> (uri, 1, 0, "PreviewRangeParameter");
-    qmlRegisterType<unity::action::PreviewRangeParameter> (uri, 1, 1, "PreviewRangeParameter");
+    qmlRegisterType<unity::action::PreviewRangeParameter, 1> (uri, 1, 1, "PreviewRangeParameter");
 
     // Don't provide menu item just yet.
     //qmlRegisterType<unity::action::MenuItem> (uri, 1, 0, "MenuItem");
@@ -19,16 +19,47 @@
 using namespace unity::action;
 
 qml::ActionContext::ActionContext(QObject *parent)
-    : unity::action::ActionContext(parent)
+    : unity::action::ActionContext(parent),
+      completed(true),
+      addScheduled(false)
 {
 
 }
 
 qml::ActionContext::~ActionContext()
 {
-    foreach(Action *action, actions()) {
-        removeAction(action);
+    // the static list callback hides the base class clear()
+    unity::action::ActionContext::clear();
+}
+
+void
+qml::ActionContext::classBegin()
+{
+    completed = false;
+}
+
+void
+qml::ActionContext::componentComplete()
+{
+    completed = true;
+    addPendingActions();
+}
+
+/* Adds the pending actions at once instead of updating the context for
+ * each of them. Called when the component is complete and once per event
+ * loop iteration for the actions appended after that, e.g. by a Repeater.
+ */
+void
+qml::ActionContext::addPendingActions()
+{
+    addScheduled = false;
+    QList<Action *> actions;
+    foreach (const QPointer<Action> &action, pendingActions) {
+        if (!action.isNull())
+            actions.append(action.data());
     }
+    pendingActions.clear();
+    addActions(actions);
 }
 
 QQmlListProperty<Action>
@@ -48,7 +79,11 @@ qml::ActionContext::append(QQmlListProperty<Action> *list,
 {
     qml::ActionContext *ctx = qobject_cast<qml::ActionContext *>(list->object);
     if (ctx) {
-        ctx->addAction(action);
+        ctx->pendingActions.append(action);
+        if (ctx->completed && !ctx->addScheduled) {
+            ctx->addScheduled = true;
+            QMetaObject::invokeMethod(ctx, "addPendingActions", Qt::QueuedConnection);
+        }
         return;
     }
 
@@ -60,9 +95,8 @@ qml::ActionContext::clear(QQmlListProperty<Action> *list)
 {
     qml::ActionContext *ctx = qobject_cast<qml::ActionContext *>(list->object);
     if (ctx) {
-        foreach(Action *action, ctx->actions()) {
-            ctx->removeAction(action);
-        }
+        ctx->pendingActions.clear();
+        ctx->unity::action::ActionContext::clear();
         return;
     }
 
@@ -74,7 +108,7 @@ qml::ActionContext::count(QQmlListProperty<Action> *list)
 {
     qml::ActionContext *ctx = qobject_cast<qml::ActionContext *>(list->object);
     if (ctx) {
-        return ctx->actions().count();
+        return ctx->unity::action::ActionContext::count() + ctx->pendingActions.count();
     }
 
     Q_ASSERT(0); // should not be reached
@@ -26,14 +26,18 @@ namespace qml {
 }
 
 #include <QQmlListProperty>
+#include <QQmlParserStatus>
+#include <QPointer>
 
 #include <unity/action/ActionContext>
 #include <unity/action/Action>
 
-class Q_DECL_EXPORT unity::action::qml::ActionContext : public unity::action::ActionContext
+class Q_DECL_EXPORT unity::action::qml::ActionContext : public unity::action::ActionContext,
+                                                        public QQmlParserStatus
 {
     Q_OBJECT
     Q_DISABLE_COPY(ActionContext)
+    Q_INTERFACES(QQmlParserStatus)
 
     Q_PROPERTY(QQmlListProperty<unity::action::Action> actions
                READ action_list)
@@ -46,7 +50,17 @@ public:
 
         QQmlListProperty<unity::action::Action> action_list();
 
+        void classBegin();
+        void componentComplete();
+
+private slots:
+    void addPendingActions();
+
 private:
+    // actions appended but not yet added to the context
+    QList<QPointer<unity::action::Action> > pendingActions;
+    bool completed;
+    bool addScheduled;
 
     static void append(QQmlListProperty<unity::action::Action> *list,unity::action::Action *action);
     static void clear(QQmlListProperty<unity::action::Action> *list);
@@ -19,21 +19,49 @@
 using namespace unity::action;
 
 qml::ActionManager::ActionManager(QObject *parent)
-    : unity::action::ActionManager(parent)
+    : unity::action::ActionManager(parent),
+      completed(true),
+      addScheduled(false)
 {
 
 }
 
 qml::ActionManager::~ActionManager()
 {
-    foreach(Action *action, globalContext()->actions()) {
-        removeAction(action);
-    }
+    globalContext()->clear();
     foreach(ActionContext *context, localContexts()) {
         removeLocalContext(context);
     }
 }
 
+void
+qml::ActionManager::classBegin()
+{
+    completed = false;
+}
+
+void
+qml::ActionManager::componentComplete()
+{
+    completed = true;
+    addPendingActions();
+}
+
+/* Like qml::ActionContext adds the actions appended to the list at once
+ * instead of updating the global context for each of them.
+ */
+void
+qml::ActionManager::addPendingActions()
+{
+    addScheduled = false;
+    QList<Action *> actions;
+    foreach (const QPointer<Action> &action, pendingActions) {
+        if (!action.isNull())
+            actions.append(action.data());
+    }
+    pendingActions.clear();
+    globalContext()->addActions(actions);
+}
 
 QQmlListProperty<unity::action::ActionContext>
 qml::ActionManager::localContexts_list()
@@ -88,7 +116,7 @@ qml::ActionManager::contextCount(QQmlListProperty<ActionContext> *list)
 {
     qml::ActionManager *manager = qobject_cast<qml::ActionManager *>(list->object);
     if (manager) {
-        return manager->localContexts().count();
+        return manager->constLocalContexts().count();
     }
 
     Q_ASSERT(0); // should not be reached
@@ -100,7 +128,11 @@ qml::ActionManager::actionAppend(QQmlListProperty<Action> *list, Action *action)
 {
     qml::ActionManager *manager = qobject_cast<qml::ActionManager *>(list->object);
     if (manager) {
-        manager->globalContext()->addAction(action);
+        manager->pendingActions.append(action);
+        if (manager->completed && !manager->addScheduled) {
+            manager->addScheduled = true;
+            QMetaObject::invokeMethod(manager, "addPendingActions", Qt::QueuedConnection);
+        }
         return;
     }
 
@@ -112,9 +144,8 @@ qml::ActionManager::actionClear(QQmlListProperty<Action> *list)
 {
     qml::ActionManager *manager = qobject_cast<qml::ActionManager *>(list->object);
     if (manager) {
-        foreach(Action *action, manager->globalContext()->actions()) {
-            manager->globalContext()->removeAction(action);
-        }
+        manager->pendingActions.clear();
+        manager->globalContext()->clear();
         return;
     }
 
@@ -126,7 +157,7 @@ qml::ActionManager::actionCount(QQmlListProperty<Action> *list)
 {
     qml::ActionManager *manager = qobject_cast<qml::ActionManager *>(list->object);
     if (manager) {
-        return manager->globalContext()->actions().count();
+        return manager->globalContext()->count() + manager->pendingActions.count();
     }
 
     Q_ASSERT(0); // should not be reached
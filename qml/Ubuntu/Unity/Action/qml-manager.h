@@ -18,6 +18,9 @@
 #define UNITY_ACTION_QML_ACTION_MANAGER
 
 #include <QQmlListProperty>
+#include <QQmlParserStatus>
+#include <QPointer>
+
 #include <unity/action/ActionManager>
 #include <unity/action/Action>
 #include <unity/action/ActionContext>
@@ -30,10 +33,12 @@ namespace qml {
 }
 }
 
-class unity::action::qml::ActionManager : public unity::action::ActionManager
+class unity::action::qml::ActionManager : public unity::action::ActionManager,
+                                           public QQmlParserStatus
 {
     Q_OBJECT
     Q_DISABLE_COPY(ActionManager)
+    Q_INTERFACES(QQmlParserStatus)
 
     Q_PROPERTY(QQmlListProperty<unity::action::ActionContext> localContexts
                READ localContexts_list)
@@ -50,7 +55,18 @@ public:
     QQmlListProperty<unity::action::ActionContext> localContexts_list();
     QQmlListProperty<unity::action::Action> actions_list();
 
+    void classBegin();
+    void componentComplete();
+
+private slots:
+    void addPendingActions();
+
 private:
+    // actions appended but not yet added to the global context
+    QList<QPointer<unity::action::Action> > pendingActions;
+    bool completed;
+    bool addScheduled;
+
     static void contextAppend(QQmlListProperty<ActionContext> *list, ActionContext *context);
     static void contextClear(QQmlListProperty<ActionContext> *list);
     static int contextCount(QQmlListProperty<ActionContext> *list);
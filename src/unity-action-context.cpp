@@ -57,7 +57,25 @@ namespace action {
 /*!
  * \fn void ActionContext::actionsChanged()
  * Notifies that the actions inside a context have changed from a call to
- * addAction() or removeAction().
+ * addAction(), removeAction(), addActions(), removeActions() or clear().
+ *
+ * The bulk functions emit the signal only once per call.
+ *
+ * \see actionsAdded(), actionsRemoved()
+ */
+
+/*!
+ * \fn void ActionContext::actionsAdded(const QList<unity::action::Action *> &actions)
+ * \param actions the actions added to the context
+ *
+ * Emitted right before actionsChanged() when actions were added.
+ */
+
+/*!
+ * \fn void ActionContext::actionsRemoved(const QList<unity::action::Action *> &actions)
+ * \param actions the actions removed from the context
+ *
+ * Emitted right before actionsChanged() when actions were removed.
  */
 }
 }
@@ -73,16 +91,38 @@ public:
 
     QSet<Action *> actions;
     bool active;
+    quint64 generation;
 
     Private(ActionContext *ctx)
         : q(ctx)
-    {}
+    {
+        generation = 0;
+    }
+
+    void emitAdded(const QList<Action *> &added);
+    void emitRemoved(const QList<Action *> &removed);
 
 public slots:
     void actionDestroyed(QObject *obj);
 
 };
 
+void
+ActionContext::Private::emitAdded(const QList<Action *> &added)
+{
+    generation++;
+    emit q->actionsAdded(added);
+    emit q->actionsChanged();
+}
+
+void
+ActionContext::Private::emitRemoved(const QList<Action *> &removed)
+{
+    generation++;
+    emit q->actionsRemoved(removed);
+    emit q->actionsChanged();
+}
+
 void
 ActionContext::Private::actionDestroyed(QObject *obj)
 {
@@ -111,6 +151,9 @@ ActionContext::ActionContext(QObject *parent)
       d(new Private(this))
 {
     d->active = false;
+
+    // for queued connections and QSignalSpy
+    qRegisterMetaType<QList<unity::action::Action *> >();
 }
 
 ActionContext::~ActionContext()
@@ -142,7 +185,7 @@ ActionContext::addAction(Action *action)
         return;
     d->actions.insert(action);
     connect(action, SIGNAL(destroyed(QObject*)), d.data(), SLOT(actionDestroyed(QObject*)));
-    emit actionsChanged();
+    d->emitAdded(QList<Action *>() << action);
 }
 
 /*!
@@ -166,7 +209,79 @@ ActionContext::removeAction(Action *action)
         return;
     action->disconnect(d.data());
     d->actions.remove(action);
-    emit actionsChanged();
+    d->emitRemoved(QList<Action *>() << action);
+}
+
+/*!
+ * Adds multiple actions to the context.
+ *
+ * \param actions Actions to be added to the context
+ *
+ * Works like calling addAction() for each of the actions, but
+ * actionsChanged() is emitted only once and only if any of the
+ * actions was not already part of the context.
+ *
+ * \note actions must not contain 0
+ */
+void
+ActionContext::addActions(const QList<Action *> &actions)
+{
+    QList<Action *> added;
+    foreach (Action *action, actions) {
+        Q_ASSERT(action != 0);
+        if (action == 0 || d->actions.contains(action))
+            continue;
+        d->actions.insert(action);
+        connect(action, SIGNAL(destroyed(QObject*)), d.data(), SLOT(actionDestroyed(QObject*)));
+        added.append(action);
+    }
+    if (!added.isEmpty())
+        d->emitAdded(added);
+}
+
+/*!
+ * Removes multiple actions from the context.
+ *
+ * \param actions Actions to be removed from the context
+ *
+ * Works like calling removeAction() for each of the actions, but
+ * actionsChanged() is emitted only once and only if any of the
+ * actions was part of the context.
+ *
+ * \note actions must not contain 0
+ */
+void
+ActionContext::removeActions(const QList<Action *> &actions)
+{
+    QList<Action *> removed;
+    foreach (Action *action, actions) {
+        Q_ASSERT(action != 0);
+        if (action == 0 || !d->actions.contains(action))
+            continue;
+        action->disconnect(d.data());
+        d->actions.remove(action);
+        removed.append(action);
+    }
+    if (!removed.isEmpty())
+        d->emitRemoved(removed);
+}
+
+/*!
+ * Removes all the actions from the context.
+ *
+ * actionsChanged() is emitted once if the context was not empty.
+ */
+void
+ActionContext::clear()
+{
+    if (d->actions.isEmpty())
+        return;
+    QList<Action *> removed = d->actions.toList();
+    foreach (Action *action, removed) {
+        action->disconnect(d.data());
+    }
+    d->actions.clear();
+    d->emitRemoved(removed);
 }
 
 bool
@@ -193,4 +308,56 @@ ActionContext::actions() const
     return d->actions;
 }
 
+/*!
+ * \returns A reference to the set of actions in the context.
+ *
+ * Unlike actions() this does not copy the set. The reference is only
+ * valid until the actions of the context change, so it must not be held
+ * across calls that add or remove actions.
+ *
+ * \sa forEachAction()
+ */
+const QSet<Action *> &
+ActionContext::constActions() const
+{
+    return d->actions;
+}
+
+/*!
+ * \returns true if \a action is part of the context.
+ */
+bool
+ActionContext::contains(Action *action) const
+{
+    return d->actions.contains(action);
+}
+
+/*!
+ * \returns The number of actions in the context.
+ */
+int
+ActionContext::count() const
+{
+    return d->actions.count();
+}
+
+/*!
+ * \fn void ActionContext::forEachAction(Visitor visitor) const
+ *
+ * Calls \a visitor with every action of the context without copying the
+ * set. The visitor must not add or remove actions of the context.
+ */
+
+/*!
+ * \returns A number that grows every time the set of actions changes.
+ *
+ * Comparing the values returned at two points in time tells whether
+ * the actions changed in between without copying the sets.
+ */
+quint64
+ActionContext::generation() const
+{
+    return d->generation;
+}
+
 #include "unity-action-context.moc"
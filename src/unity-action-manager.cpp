@@ -21,10 +21,17 @@
 #include <unity/action/PreviewRangeParameter>
 
 #include <QSet>
+#include <QHash>
+#include <QByteArray>
 #include <QDebug>
 #include <QCoreApplication>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QPointer>
 
 #include <libintl.h>
+#include <string.h>
 
 // needed for gio includes.
 #undef signals
@@ -39,6 +46,19 @@ namespace action {
  *
  * ActionManager exports the application actions to the external components.
  * See \ref page_platform-integration and \ref page_contexts for more details.
+ *
+ * By default the constructor connects to the session bus synchronously.
+ * If the UNITY_ACTION_ASYNC_BUS environment variable is set to 1 the
+ * connection is made asynchronously and the constructor returns
+ * immediately. The actions are then exported and published to the HUD
+ * as soon as the connection is ready.
+ *
+ * On destruction the manager flushes the session bus so that the removal
+ * of the exported actions reaches the other components. The flush waits
+ * for at most one second so that a stalled bus can not keep the
+ * application from quitting. The UNITY_ACTION_FLUSH_TIMEOUT environment
+ * variable sets another deadline in milliseconds, a negative value waits
+ * without a limit. See shutdownFlushTime().
  */
 
 // properties
@@ -53,8 +73,90 @@ namespace action {
  * \accessors globalContext()
  */
 
+/*!
+ * \property bool ActionManager::deferredUpdates
+ *
+ * If true the manager reconciles the changes to its contexts and actions
+ * once per event loop iteration instead of immediately.
+ *
+ * In the deferred mode the changes are only recorded when they happen and
+ * a single reconciliation pass runs when the control returns to the event
+ * loop. A state change that modifies a large number of actions at once
+ * then updates the exported actions and the HUD only once.
+ *
+ * Setting the property to false reconciles the pending changes immediately.
+ *
+ * \initvalue false
+ *
+ * \accessors deferredUpdates(), setDeferredUpdates()
+ *
+ * \notify deferredUpdatesChanged()
+ */
+
 // signals
 
+/*!
+ * \enum ActionManager::Operation
+ * \brief The kinds of operations the D-Bus traffic is accounted to.
+ *
+ * \var ActionManager::Operation ActionManager::ActionOperation
+ *
+ * Actions or contexts added or removed.
+ *
+ * \var ActionManager::Operation ActionManager::ContextSwitchOperation
+ *
+ * The active local context changed.
+ *
+ * \var ActionManager::Operation ActionManager::PropertyOperation
+ *
+ * A property of an action changed.
+ *
+ * \var ActionManager::Operation ActionManager::ParameterOperation
+ *
+ * The parameters of a PreviewAction or their properties changed.
+ *
+ * \var ActionManager::Operation ActionManager::FlushOperation
+ *
+ * Batched or deferred updates were applied.
+ *
+ * \var ActionManager::Operation ActionManager::OperationCount
+ *
+ * The number of operations.
+ */
+
+/*!
+ * \enum ActionManager::Counter
+ * \brief The kinds of D-Bus traffic counted by the manager.
+ *
+ * \var ActionManager::Counter ActionManager::ActionGroupInsert
+ *
+ * An action inserted in the exported action group.
+ *
+ * \var ActionManager::Counter ActionManager::ActionGroupRemove
+ *
+ * An action removed from the exported action group.
+ *
+ * \var ActionManager::Counter ActionManager::EnabledChange
+ *
+ * The enabled state of an exported action changed.
+ *
+ * \var ActionManager::Counter ActionManager::AttributeSet
+ *
+ * An attribute of a HUD description set.
+ *
+ * \var ActionManager::Counter ActionManager::DescriptionAdd
+ *
+ * A HUD description added to a HUD context.
+ *
+ * \var ActionManager::Counter ActionManager::StateChange
+ *
+ * The state of an exported preview parameter changed.
+ *
+ * \var ActionManager::Counter ActionManager::CounterCount
+ *
+ * The number of counters.
+ */
+
 /*!
  * \fn void ActionManager::localContextsChanged()
  *
@@ -66,6 +168,25 @@ namespace action {
  *
  * An action was either added or removed from the global context
  * or any of the local contexts the manager is currently tracking.
+ *
+ * The signal is emitted once per change of the contexts, or once per batch
+ * of updates, no matter how many actions it covers.
+ *
+ * \see actionsAdded(), actionsRemoved()
+ */
+
+/*!
+ * \fn void ActionManager::actionsAdded(const QList<unity::action::Action *> &actions)
+ * \param actions the actions the manager started tracking
+ *
+ * Emitted right before actionsChanged() when actions were added to actions().
+ */
+
+/*!
+ * \fn void ActionManager::actionsRemoved(const QList<unity::action::Action *> &actions)
+ * \param actions the actions the manager stopped tracking
+ *
+ * Emitted right before actionsChanged() when actions were removed from actions().
  */
 }
 }
@@ -73,24 +194,76 @@ namespace action {
 
 #define UNITY_ACTION_EXPORT_PATH "/com/canonical/unity/actions"
 
+// minimum number of hidden descriptions before a HUD context is rebuilt
+#define UNITY_ACTION_HUD_TOMBSTONE_LIMIT 64
+
+// milliseconds the destructor waits for the session bus flush by default
+#define UNITY_ACTION_FLUSH_TIMEOUT 1000
+
 //! \private
 struct Q_DECL_HIDDEN ContextData
 {
+    // 0 until the manager is connected to the session bus
     HudActionPublisher *publisher;
     QSet<Action *>      actions;
 
+    /* name -> gaction of the actions the context exports.
+     * For a local context this is the overlay it applies on top
+     * of the exports of the global context.
+     */
+    QHash<QByteArray, GSimpleAction *> exports;
+    // the entries each of the actions has put in exports
+    QHash<Action *, QHash<QByteArray, GSimpleAction *> > actionExports;
+    // the actions whose exports have to be collected again
+    QSet<Action *> staleExports;
+
+    /* the actions whose descriptions are published in the HUD context
+     * and the number of hidden descriptions left in the publisher.
+     */
+    QSet<Action *> hudActions;
+    int tombstones;
+
+    /* the changes reported by the context since the last update.
+     * fullUpdate is set for new contexts which are compared as a whole.
+     */
+    QSet<Action *> addedActions;
+    QSet<Action *> removedActions;
+    bool fullUpdate;
+
     ContextData() {
         publisher = 0;
+        tombstones = 0;
+        fullUpdate = true;
     }
     ContextData(const ContextData &other) {
-        publisher = (HudActionPublisher*)  g_object_ref(other.publisher);
+        publisher = other.publisher;
+        if (publisher != 0)
+            g_object_ref(publisher);
         actions   = other.actions;
+        exports   = other.exports;
+        actionExports = other.actionExports;
+        staleExports = other.staleExports;
+        hudActions = other.hudActions;
+        tombstones = other.tombstones;
+        addedActions = other.addedActions;
+        removedActions = other.removedActions;
+        fullUpdate = other.fullUpdate;
     }
     ContextData &operator= (const ContextData &other) {
         if (this != &other){
             g_clear_object(&publisher);
-            publisher = (HudActionPublisher*)  g_object_ref(other.publisher);
+            publisher = other.publisher;
+            if (publisher != 0)
+                g_object_ref(publisher);
             actions   = other.actions;
+            exports   = other.exports;
+            actionExports = other.actionExports;
+            staleExports = other.staleExports;
+            hudActions = other.hudActions;
+            tombstones = other.tombstones;
+            addedActions = other.addedActions;
+            removedActions = other.removedActions;
+            fullUpdate = other.fullUpdate;
         }
         return *this;
     }
@@ -99,6 +272,130 @@ struct Q_DECL_HIDDEN ContextData
     }
 };
 
+/* The parameter menu of a PreviewAction.
+ * GMenu has no way to replace an item: a removal and an insertion are two
+ * items-changed for the HUD. parameter_menu_splice() replaces any range of
+ * items with a single one.
+ */
+typedef struct {
+    GMenuModel parent;
+    // the attributes of each of the items
+    QList<GHashTable *> *items;
+} ParameterMenu;
+
+typedef struct {
+    GMenuModelClass parent_class;
+} ParameterMenuClass;
+
+G_DEFINE_TYPE(ParameterMenu, parameter_menu, G_TYPE_MENU_MODEL)
+
+static gboolean
+parameter_menu_is_mutable(GMenuModel *model)
+{
+    Q_UNUSED(model);
+    return TRUE;
+}
+
+static gint
+parameter_menu_get_n_items(GMenuModel *model)
+{
+    return ((ParameterMenu *)model)->items->count();
+}
+
+static void
+parameter_menu_get_item_attributes(GMenuModel  *model,
+                                   gint         position,
+                                   GHashTable **table)
+{
+    *table = g_hash_table_ref(((ParameterMenu *)model)->items->at(position));
+}
+
+static void
+parameter_menu_get_item_links(GMenuModel  *model,
+                              gint         position,
+                              GHashTable **table)
+{
+    Q_UNUSED(model);
+    Q_UNUSED(position);
+    *table = g_hash_table_new(g_str_hash, g_str_equal);
+}
+
+static void
+parameter_menu_finalize(GObject *object)
+{
+    ParameterMenu *menu = (ParameterMenu *)object;
+    foreach (GHashTable *attributes, *menu->items) {
+        g_hash_table_unref(attributes);
+    }
+    delete menu->items;
+    G_OBJECT_CLASS(parameter_menu_parent_class)->finalize(object);
+}
+
+static void
+parameter_menu_init(ParameterMenu *menu)
+{
+    menu->items = new QList<GHashTable *>();
+}
+
+static void
+parameter_menu_class_init(ParameterMenuClass *klass)
+{
+    GMenuModelClass *model_class = G_MENU_MODEL_CLASS(klass);
+    model_class->is_mutable = parameter_menu_is_mutable;
+    model_class->get_n_items = parameter_menu_get_n_items;
+    model_class->get_item_attributes = parameter_menu_get_item_attributes;
+    model_class->get_item_links = parameter_menu_get_item_links;
+    G_OBJECT_CLASS(klass)->finalize = parameter_menu_finalize;
+}
+
+static ParameterMenu *
+parameter_menu_new()
+{
+    return (ParameterMenu *)g_object_new(parameter_menu_get_type(), NULL);
+}
+
+/* Copies the attributes of a parameter item, like GMenu does when an
+ * item is inserted. These are the attributes the manager sets.
+ */
+static GHashTable *
+parameter_menu_item_attributes(GMenuItem *item)
+{
+    static const char *const names[] = {
+        G_MENU_ATTRIBUTE_LABEL,
+        G_MENU_ATTRIBUTE_ACTION,
+        G_MENU_ATTRIBUTE_TARGET,
+        "parameter-type",
+        "min",
+        "max",
+        NULL
+    };
+    GHashTable *attributes = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                                   g_free, (GDestroyNotify)g_variant_unref);
+    for (int i = 0; names[i] != NULL; i++) {
+        GVariant *value = g_menu_item_get_attribute_value(item, names[i], NULL);
+        if (value != NULL)
+            g_hash_table_insert(attributes, g_strdup(names[i]), value);
+    }
+    return attributes;
+}
+
+// replaces the removed items at position with the added ones
+static void
+parameter_menu_splice(ParameterMenu *menu,
+                      int position,
+                      int removed,
+                      const QList<GMenuItem *> &added)
+{
+    for (int i = 0; i < removed; i++) {
+        g_hash_table_unref(menu->items->takeAt(position));
+    }
+    for (int i = 0; i < added.count(); i++) {
+        menu->items->insert(position + i, parameter_menu_item_attributes(added[i]));
+    }
+    if (removed > 0 || !added.isEmpty())
+        g_menu_model_items_changed(G_MENU_MODEL(menu), position, removed, added.count());
+}
+
 //! \private
 struct Q_DECL_HIDDEN ParameterData
 {
@@ -137,25 +434,79 @@ struct Q_DECL_HIDDEN ParameterData
 };
 
 
+/* How the activations of the gaction of an action are delivered.
+ * Decided when the action and its gaction are created, so that
+ * action_activated() does not have to look at the action at all.
+ */
+struct Q_DECL_HIDDEN ActivationHandler
+{
+    enum Kind {
+        TriggerNone,
+        TriggerString,
+        TriggerInt,
+        TriggerBool,
+        TriggerReal,
+        Preview
+    };
+
+    Action *action;
+    PreviewAction *previewAction; // 0 unless kind is Preview
+    Kind kind;
+    /* the range parameters to flush before a preview ends.
+     * A deferred update might not have dropped a deleted one yet.
+     */
+    QList<QPointer<PreviewRangeParameter> > ranges;
+};
+
 //! \private
 struct Q_DECL_HIDDEN ActionData
 {
-
+    /* created when the action is first exported,
+     * see createGAction() and createDescription()
+     */
     HudActionDescription  *desc;
     GSimpleAction         *gaction;
 
     bool isPreviewAction;
 
+    // passed to the "activate" handler of the gaction
+    QSharedPointer<ActivationHandler> handler;
+
     /* preview action data */
     QHash<PreviewParameter *, ParameterData> params;
 
     /* menu containing the parameter information */
-    GMenu *paramMenu;
+    ParameterMenu *paramMenu;
+    /* the parameters in the order their items are in paramMenu */
+    QList<PreviewParameter *> menuItems;
+
+    /* the contexts containing the action */
+    QSet<ActionContext *> contexts;
+
+    /* the properties exported to the HUD description and the gaction */
+    enum Property {
+        Enabled     = 0x01,
+        Text        = 0x02,
+        Description = 0x04,
+        Keywords    = 0x08,
+        CommitLabel = 0x10,
+        AllProperties = 0x1f
+    };
+
+    /* the encoded attribute values set on the desc.
+     * cachedProperties tells which of them are valid.
+     */
+    QByteArray text;
+    QByteArray description;
+    QByteArray keywords;
+    QByteArray commitLabel;
+    int cachedProperties;
 
     ActionData() {
         desc      = 0;
         gaction   = 0;
         paramMenu = 0;
+        cachedProperties = 0;
 
         isPreviewAction = false;
     }
@@ -165,26 +516,50 @@ struct Q_DECL_HIDDEN ActionData
             g_clear_object(&gaction);
             g_clear_object(&paramMenu);
 
-            desc      = (HudActionDescription*) g_object_ref(other.desc);
-            gaction   = (GSimpleAction *)       g_object_ref(other.gaction);
+            desc      = other.desc;
+            if (desc != 0)
+                g_object_ref(desc);
+            gaction   = other.gaction;
+            if (gaction != 0)
+                g_object_ref(gaction);
             params    = other.params;
             paramMenu = other.paramMenu;
             if (paramMenu != 0)
                 g_object_ref(paramMenu);
+            menuItems = other.menuItems;
+            contexts  = other.contexts;
+            text        = other.text;
+            description = other.description;
+            keywords    = other.keywords;
+            commitLabel = other.commitLabel;
+            cachedProperties = other.cachedProperties;
 
             isPreviewAction = other.isPreviewAction;
+            handler = other.handler;
         }
         return *this;
     }
     ActionData(const ActionData &other) {
-        desc      = (HudActionDescription*) g_object_ref(other.desc);
-        gaction   = (GSimpleAction *)       g_object_ref(other.gaction);
+        desc      = other.desc;
+        if (desc != 0)
+            g_object_ref(desc);
+        gaction   = other.gaction;
+        if (gaction != 0)
+            g_object_ref(gaction);
         params    = other.params;
         paramMenu = other.paramMenu;
         if (paramMenu != 0)
             g_object_ref(paramMenu);
+        menuItems = other.menuItems;
+        contexts  = other.contexts;
+        text        = other.text;
+        description = other.description;
+        keywords    = other.keywords;
+        commitLabel = other.commitLabel;
+        cachedProperties = other.cachedProperties;
 
         isPreviewAction = other.isPreviewAction;
+        handler = other.handler;
     }
     ~ActionData() {
         g_clear_object(&desc);
@@ -193,14 +568,6 @@ struct Q_DECL_HIDDEN ActionData
     }
 };
 
-// needed for QHash.key()
-//! \private
-bool operator== (const ActionData &a, const ActionData &b) {
-    // comparing these pointers is enough
-    return a.gaction == b.gaction &&
-           a.desc    == b.desc;
-}
-
 namespace {
 class QuitAction: public Action {
     Q_OBJECT
@@ -216,7 +583,15 @@ public:
         built_in_actions << action;
     }
 
-    QSet<Action *> allActions() {
+    const QSet<Action *> &builtInActions() const {
+        return built_in_actions;
+    }
+
+    bool containsAction(Action *action) const {
+        return contains(action) || built_in_actions.contains(action);
+    }
+
+    QSet<Action *> allActions() const {
         return actions() + built_in_actions;
     }
 private:
@@ -226,6 +601,71 @@ private:
 static inline char * _(const char *__msgid) {
         return gettext(__msgid);
 }
+
+static qint64 lastShutdownFlushTime = -1;
+
+/* state of a flush bounded by a deadline.
+ * Shared by the manager and the flushing thread, the last one to
+ * release it frees it together with the reference to the bus.
+ */
+struct FlushState {
+    GDBusConnection *bus;
+    GMutex mutex;
+    GCond cond;
+    bool finished;
+    gint refs;
+};
+
+static void flush_state_unref(FlushState *state)
+{
+    if (!g_atomic_int_dec_and_test(&state->refs))
+        return;
+    g_object_unref(state->bus);
+    g_mutex_clear(&state->mutex);
+    g_cond_clear(&state->cond);
+    delete state;
+}
+
+static gpointer flush_thread(gpointer user_data)
+{
+    FlushState *state = (FlushState *)user_data;
+    g_dbus_connection_flush_sync(state->bus, NULL, NULL);
+    g_mutex_lock(&state->mutex);
+    state->finished = true;
+    g_cond_signal(&state->cond);
+    g_mutex_unlock(&state->mutex);
+    flush_state_unref(state);
+    return NULL;
+}
+
+// the states the HUD passes to a PreviewAction
+enum PreviewState {
+    UnknownState,
+    StartState,
+    EndState,
+    CommitState,
+    ResetState,
+    CancelState
+};
+
+// maps the raw state string without building a QString
+static PreviewState previewState(const gchar *state)
+{
+    switch (state[0]) {
+    case 's':
+        return strcmp(state, "start") == 0 ? StartState : UnknownState;
+    case 'e':
+        return strcmp(state, "end") == 0 ? EndState : UnknownState;
+    case 'c':
+        if (strcmp(state, "commit") == 0)
+            return CommitState;
+        return strcmp(state, "cancel") == 0 ? CancelState : UnknownState;
+    case 'r':
+        return strcmp(state, "reset") == 0 ? ResetState : UnknownState;
+    default:
+        return UnknownState;
+    }
+}
 }
 
 //! \private
@@ -239,6 +679,8 @@ public:
     QSet<Action *> actions;
 
     GlobalActionContext *globalContext;
+    // see ActionManager::generation()
+    quint64 generation;
     QSet<ActionContext *> localContexts;
 
     QScopedPointer<Action> quitAction;
@@ -247,40 +689,170 @@ public:
 
     QHash<ActionContext *, ContextData> contextData;
     QHash<Action *, ActionData>         actionData;
+    // range parameter -> the preview actions it is part of
+    QMultiHash<PreviewParameter *, Action *> parameterOwners;
     HudManager *hudManager;
 
     GSimpleActionGroup *actionGroup;
     guint exportId;
 
+    // name -> gaction currently inserted in the actionGroup.
+    // holds a reference to each of the gactions.
+    QHash<QByteArray, GSimpleAction *> exportedActions;
+    // the local context whose exports are applied on top of the global ones
+    ActionContext *overlayContext;
+    // the names whose gaction in the actionGroup might have changed
+    QSet<QByteArray> dirtyExportNames;
+
     GDBusConnection *sessionBus;
+    // the pending asynchronous g_bus_get()
+    GCancellable *busCancellable;
+
+    /* batched updates, see ActionManager::beginUpdate() */
+    int updateDepth;
+    QSet<ActionContext *> dirtyContexts;
+    QSet<Action *> dirtyActions;     // name or parameterType changed
+    QHash<Action *, int> dirtyProperties;  // ActionData::Property flags
+    QSet<Action *> dirtyParameters;  // PreviewAction parameters changed
+    bool actionGroupDirty;
+    bool hudContextDirty;
+    // the changes to actions() not signalled yet, see emitActionChanges()
+    QList<Action *> pendingAddedActions;
+    QList<Action *> pendingRemovedActions;
+
+    /* deferred updates, see ActionManager::deferredUpdates */
+    bool deferredUpdates;
+    QTimer deferredTimer;
+
+    /* D-Bus traffic accounting, see ActionManager::trafficCount() */
+    ActionManager::Operation operation;
+    int traffic[ActionManager::OperationCount][ActionManager::CounterCount];
+    QTimer trafficDumpTimer;
+
+    void countTraffic(ActionManager::Counter counter, int amount = 1) {
+        traffic[operation][counter] += amount;
+    }
+
+    // attributes the traffic caused inside a block to an operation
+    struct OperationScope {
+        OperationScope(Private *d, ActionManager::Operation operation)
+            : d(d), saved(d->operation) {
+            d->operation = operation;
+        }
+        ~OperationScope() {
+            d->operation = saved;
+        }
+        Private *d;
+        ActionManager::Operation saved;
+    };
 
     Private(ActionManager *mgr)
-        : q(mgr)
+        : QObject(mgr),
+          q(mgr)
     {
+        // lets the tests find the invokable test accessors below
+        setObjectName("unity-action-manager-private");
         globalContext = new GlobalActionContext();
+        generation = 0;
         hudManager = 0;
+        sessionBus = 0;
+        busCancellable = 0;
+        exportId = 0;
+
+        updateDepth = 0;
+        actionGroupDirty = false;
+        hudContextDirty = false;
+
+        deferredUpdates = false;
+        deferredTimer.setSingleShot(true);
+        deferredTimer.setInterval(0);
+        connect(&deferredTimer, SIGNAL(timeout()), this, SLOT(deferredFlush()));
+
+        operation = ActionManager::ActionOperation;
+        memset(traffic, 0, sizeof(traffic));
+        bool ok;
+        int interval = qgetenv("UNITY_ACTION_TRAFFIC_DUMP").toInt(&ok);
+        if (ok && interval > 0) {
+            trafficDumpTimer.setInterval(interval);
+            connect(&trafficDumpTimer, SIGNAL(timeout()), this, SLOT(dumpTraffic()));
+            trafficDumpTimer.start();
+        }
     }
     ~Private() {
+        /* quitAction is destroyed after the members actionDestroyed()
+         * uses, so it must not reach the slot any more.
+         */
+        if (!quitAction.isNull())
+            quitAction->disconnect(this);
         delete globalContext;
         g_clear_object(&hudManager);
+        foreach (GSimpleAction *gaction, exportedActions) {
+            g_object_unref(gaction);
+        }
     }
 
+    /* session bus */
+    void connectHud();
+    void exportActionGroup();
+    void flushSessionBus();
+    static void bus_acquired(GObject      *source,
+                             GAsyncResult *result,
+                             gpointer      user_data);
+
     /* ActionContext */
     void updateContext(ActionContext *context);
+    void scheduleContextUpdate(ActionContext *context);
     void createContext(ActionContext *context);
     void destroyContext(ActionContext *context);
+    void releaseAction(ActionContext *context, Action *action);
+    void updateHudContext(ActionContext *context);
     void updateHudContext(ActionContext *context,
-                          QSet<Action *> oldActions);
-    // updates the exported action group.
+                          const QSet<Action *> &newActions,
+                          const QSet<Action *> &removedActions);
+    HudActionPublisher *createPublisher();
+    QList<ActionContext *> hudContexts(Action *action);
+    void retireTombstones(ActionContext *context);
+    // updates the names of the exported action group that might have changed
     void updateActionGroup();
+    // replaces the overlay of the old active local context with the new one
+    void switchActionGroup();
+    void exportAction(const QByteArray &name, GSimpleAction *gaction);
+    bool exportsVisible(ActionContext *context) const {
+        return context == globalContext || context == activeLocalContext
+                || context == overlayContext;
+    }
+    void collectExports(ActionContext *context);
+    void removeActionExports(ActionContext *context, Action *action);
+    void invalidateExports(Action *action);
     void setActiveContext(ActionContext *context);
+    // updates the action group and the HUD context unless updates are batched
+    void syncActionGroup();
+    void switchHudContext();
+    void flushUpdates();
+    // returns true if the caller should only record the change
+    bool deferUpdate();
+    bool updatesSuspended() const {
+        return updateDepth > 0 || deferredTimer.isActive();
+    }
 
     /* Action */
     void createAction(Action *action);
     void destroyAction(Action *action);
+    void emitActionChanges();
     void createActionData(Action *action, ActionData &adata);
-    void updateActionDescription(Action *action, HudActionDescription *desc);
+    GSimpleAction *createGAction(Action *action, const ActionData &adata);
+    HudActionDescription *createDescription(Action *action, ActionData &adata);
+    void checkPreviewParameterType(Action *action);
+    void replaceGAction(Action *action, GSimpleAction *gaction);
+    void actionPropertiesChanged(Action *action, int properties);
+    void actionNameOrTypeChanged(Action *action);
+    void previewActionParametersChanged(PreviewAction *action);
+    void updateActionProperties(Action *action, ActionData &adata, int properties);
+    // returns the number of attributes set
+    int updateDescriptionAttributes(Action *action, ActionData &adata,
+                                    HudActionDescription *desc, int properties);
     void updateActionsWhenNameOrTypeHaveChanged(Action *action);
+    static void previewActivated(ActivationHandler *handler, const gchar *state);
     static void action_activated(GSimpleAction *action,
                                  GVariant      *parameter,
                                  gpointer       user_data);
@@ -288,7 +860,8 @@ public:
     /* PreviewAction */
     ActionData createHudPreviewAction(PreviewAction *action);
     void updatePreviewActionParameters(PreviewAction *action, ActionData &adata);
-    void updateParameterMenu(PreviewAction *action, const ActionData &adata);
+    void updateParameterMenu(PreviewAction *action, ActionData &adata);
+    void replaceParameterMenuItem(PreviewParameter *parameter, const ActionData &adata);
 
     /* PreviewRangeParameter */
     void updateRange(PreviewRangeParameter * param, const ActionData &adata);
@@ -296,6 +869,9 @@ public:
     static void range_action_activated(GSimpleAction *simpleaction,
                                        GVariant      *parameter,
                                        gpointer       user_data);
+    static void range_action_change_state(GSimpleAction *simpleaction,
+                                          GVariant      *value,
+                                          gpointer       user_data);
 
 
 
@@ -303,17 +879,11 @@ public slots:
 
     /* ActionContext signals */
     void contextActiveChanged(bool value);
-    void contextActionsChanged();
-
-    /* Action signals */
-    void actionNameChanged();
-    void actionParameterTypeChanged();
-    void actionEnabledChanged();
-    void actionPropertiesChanged(); // for all the rest
+    void contextActionsAdded(const QList<unity::action::Action *> &actions);
+    void contextActionsRemoved(const QList<unity::action::Action *> &actions);
 
-    /* PreviewAction signals */
-    void previewActionParametersChanged();
-    void previewActionCommitLabelChanged();
+    /* Action and PreviewAction signals */
+    void actionChanged(unity::action::Action::ChangeMask changes);
 
     /* PreviewRangeParameter signals */
     void previewRangeParameterValueChanged();
@@ -321,6 +891,16 @@ public slots:
 
     /* QObject destroy() handlers */
     void contextDestroyed(QObject *obj);
+    void actionDestroyed(QObject *obj);
+
+    void deferredFlush();
+    void dumpTraffic();
+
+public:
+    /* Test accessors, not part of the API. The tests invoke them through
+     * the meta-object of the child named "unity-action-manager-private".
+     */
+    Q_INVOKABLE void *parameterMenu(QObject *action) const;
 };
 
 
@@ -340,30 +920,12 @@ ActionManager::ActionManager(QObject *parent)
       d(new Private(this))
 {
     d->activeLocalContext = 0;
+    d->overlayContext = 0;
 
-    GError *error = NULL;
-    d->sessionBus = g_bus_get_sync(G_BUS_TYPE_SESSION, NULL, &error);
-    if (error != NULL) {
-        qWarning("%s:\n"
-                 "\tCould not get session bus. Actions will not be available through D-Bus.\n"
-                 "\tReason: %s",
-                 __PRETTY_FUNCTION__,
-                 error->message);
-        g_error_free(error);
-        error = NULL;
-    }
-
-    const char *appid = getenv("APP_ID");
-    if (appid == 0) {
-        qWarning("%s:\n"
-                 "\tCould not determine application identifier. HUD will not work properly.\n"
-                 "\tProvide your application identifier in $APP_ID environment variable.",
-                 __PRETTY_FUNCTION__);
-        appid = "unknown";
-    }
-    d->hudManager = hud_manager_new(appid);
-
-    connect(d->globalContext, SIGNAL(actionsChanged()), d.data(), SLOT(contextActionsChanged()));
+    connect(d->globalContext, SIGNAL(actionsAdded(QList<unity::action::Action*>)),
+            d.data(), SLOT(contextActionsAdded(QList<unity::action::Action*>)));
+    connect(d->globalContext, SIGNAL(actionsRemoved(QList<unity::action::Action*>)),
+            d.data(), SLOT(contextActionsRemoved(QList<unity::action::Action*>)));
     connect(d->globalContext, SIGNAL(activeChanged(bool)), d.data(), SLOT(contextActiveChanged(bool)));
     connect(d->globalContext, SIGNAL(destroyed(QObject*)), d.data(), SLOT(contextDestroyed(QObject *)));
 
@@ -373,41 +935,57 @@ ActionManager::ActionManager(QObject *parent)
     d->quitAction->setText(_("Quit"));
     d->quitAction->setDescription(_("Quit the application"));
     d->quitAction->setKeywords(_("Exit;Close"));
-    connect(d->quitAction.data(), SIGNAL(triggered(QVariant)), this, SIGNAL(quit()));
+    connect(d->quitAction.data(), SIGNAL(triggeredNone()), this, SIGNAL(quit()));
 
-    d->createContext(d->globalContext);
-    d->globalContext->addBuiltInAction(d->quitAction.data());
-    d->updateContext(d->globalContext);
-    hud_manager_switch_window_context(d->hudManager,
-                                      d->contextData[d->globalContext].publisher);
-
-    d->exportId = 0;
-    if (d->sessionBus) {
-        d->exportId = g_dbus_connection_export_action_group(d->sessionBus,
-                                                            UNITY_ACTION_EXPORT_PATH,
-                                                            G_ACTION_GROUP(d->actionGroup),
-                                                            &error);
-        if (d->exportId == 0) {
-            Q_ASSERT(error != NULL);
+    if (qgetenv("UNITY_ACTION_ASYNC_BUS") == "1") {
+        /* The exports and the HUD contexts are kept in the manager
+         * and get published when the connection is ready.
+         */
+        d->busCancellable = g_cancellable_new();
+        g_bus_get(G_BUS_TYPE_SESSION,
+                  d->busCancellable,
+                  Private::bus_acquired,
+                  d.data());
+    } else {
+        GError *error = NULL;
+        d->sessionBus = g_bus_get_sync(G_BUS_TYPE_SESSION, NULL, &error);
+        if (error != NULL) {
             qWarning("%s:\n"
-                     "\tCould not export the main action group. Actions will not be available through D-Bus.\n"
+                     "\tCould not get session bus. Actions will not be available through D-Bus.\n"
                      "\tReason: %s",
                      __PRETTY_FUNCTION__,
                      error->message);
             g_error_free(error);
             error = NULL;
         }
+        d->connectHud();
     }
+
+    d->createContext(d->globalContext);
+    d->globalContext->addBuiltInAction(d->quitAction.data());
+    d->updateContext(d->globalContext);
+    d->switchHudContext();
+
+    if (d->busCancellable == 0)
+        d->exportActionGroup();
 }
 
 ActionManager::~ActionManager()
 {
     d->globalContext->disconnect(d.data());
+    if (d->busCancellable != 0) {
+        // bus_acquired() must not touch the manager any more
+        g_cancellable_cancel(d->busCancellable);
+        g_clear_object(&d->busCancellable);
+    }
     if (d->exportId != 0) {
         Q_ASSERT(d->sessionBus != 0);
         g_dbus_connection_unexport_action_group(d->sessionBus,
                                                 d->exportId);
-        g_dbus_connection_flush_sync(d->sessionBus, NULL, NULL);
+        QElapsedTimer timer;
+        timer.start();
+        d->flushSessionBus();
+        lastShutdownFlushTime = timer.nsecsElapsed() / 1000;
     }
     g_clear_object(&d->sessionBus);
 }
@@ -479,11 +1057,14 @@ ActionManager::addLocalContext(ActionContext *context)
         return;
     d->localContexts.insert(context);
     connect(context, SIGNAL(activeChanged(bool)), d.data(), SLOT(contextActiveChanged(bool)));
-    connect(context, SIGNAL(actionsChanged()), d.data(), SLOT(contextActionsChanged()));
+    connect(context, SIGNAL(actionsAdded(QList<unity::action::Action*>)),
+            d.data(), SLOT(contextActionsAdded(QList<unity::action::Action*>)));
+    connect(context, SIGNAL(actionsRemoved(QList<unity::action::Action*>)),
+            d.data(), SLOT(contextActionsRemoved(QList<unity::action::Action*>)));
     connect(context, SIGNAL(destroyed(QObject*)), d.data(), SLOT(contextDestroyed(QObject *)));
 
     d->createContext(context);
-    d->updateContext(context);
+    d->scheduleContextUpdate(context);
     emit localContextsChanged();
 
     if (context->active()) {
@@ -518,8 +1099,10 @@ ActionManager::removeLocalContext(ActionContext *context)
 
     d->destroyContext(context);
     if (d->activeLocalContext == context) {
+        Private::OperationScope scope(d.data(), ContextSwitchOperation);
         d->activeLocalContext = 0;
-        d->updateActionGroup();
+        d->switchActionGroup();
+        d->switchHudContext();
     }
     emit localContextsChanged();
 }
@@ -533,6 +1116,17 @@ ActionManager::localContexts() const
     return d->localContexts;
 }
 
+/*!
+ * \returns A reference to the set of local contexts without copying it.
+ *
+ * The reference is only valid until a local context is added or removed.
+ */
+const QSet<ActionContext *> &
+ActionManager::constLocalContexts() const
+{
+    return d->localContexts;
+}
+
 /*!
  * \returns The set of actions the manager is currently aware of.
  *
@@ -545,100 +1139,448 @@ ActionManager::actions() const
     return d->actions;
 }
 
+/*!
+ * \returns A reference to the set of actions without copying it.
+ *
+ * The reference is only valid until the set of actions changes.
+ */
+const QSet<Action *> &
+ActionManager::constActions() const
+{
+    return d->actions;
+}
 
-/************************************************************************/
-/*                         ActionContext                                */
-/************************************************************************/
+/*!
+ * \returns true if the manager is currently aware of \a action.
+ */
+bool
+ActionManager::containsAction(Action *action) const
+{
+    return d->actions.contains(action);
+}
 
-void
-ActionManager::Private::createContext(ActionContext *context)
+/*!
+ * \returns The number of actions the manager is currently aware of.
+ */
+int
+ActionManager::actionCount() const
 {
-    Q_ASSERT(!contextData.contains(context));
-    static int id = 0;
+    return d->actions.count();
+}
 
-    ContextData cdata;
-    /* create a new HUD context */
-    cdata.publisher = hud_action_publisher_new(HUD_ACTION_PUBLISHER_ALL_WINDOWS,
-                                               qPrintable(QString("action_context_%1").arg(id++)));
-    hud_action_publisher_add_action_group(cdata.publisher,
-                                          "hud",
-                                          UNITY_ACTION_EXPORT_PATH);
-    hud_manager_add_actions(hudManager, cdata.publisher);
-    contextData.insert(context, cdata);
+/*!
+ * \returns A number that grows every time actions() changes.
+ *
+ * \see ActionContext::generation()
+ */
+quint64
+ActionManager::generation() const
+{
+    return d->generation;
 }
 
+/*!
+ * Starts a batch of updates.
+ *
+ * Until the matching endUpdate() is called the manager only records the
+ * changes made to its contexts and actions. The changes are then reconciled
+ * in a single pass which updates the exported actions and the HUD only once.
+ * This makes building contexts with a large number of actions considerably
+ * cheaper:
+ * \code
+ *     manager->beginUpdate();
+ *     foreach (Action *action, documentActions)
+ *         context->addAction(action);
+ *     manager->addLocalContext(context);
+ *     manager->endUpdate();
+ * \endcode
+ *
+ * Calls to beginUpdate() and endUpdate() can be nested; the changes are
+ * reconciled when the outermost endUpdate() is called.
+ *
+ * \note actions() and actionsChanged() reflect the actions added inside
+ *       the batch only after the outermost endUpdate().
+ */
 void
-ActionManager::Private::destroyContext(ActionContext *context)
+ActionManager::beginUpdate()
 {
-    Q_ASSERT(contextData.contains(context));
-    ContextData &cdata = contextData[context];
-
-    QSet<Action *> actions = cdata.actions;
-    foreach (Action *action, actions) {
+    d->updateDepth++;
+}
 
-        // remove the action from this context
-        cdata.actions.remove(action);
-
-        // when actions are removed from this context
-        // we can't destroy their ActionData if any of the
-        // other contexts contain the action.
-        bool inUse = false;
-        foreach (const ContextData &cdata, contextData) {
-            if (cdata.actions.contains(action)) {
-                inUse = true;
-                break;
-            }
-        }
-        if (!inUse) {
-            destroyAction(action);
-        }
+/*!
+ * Ends a batch of updates started with beginUpdate().
+ */
+void
+ActionManager::endUpdate()
+{
+    Q_ASSERT(d->updateDepth > 0);
+    if (d->updateDepth <= 0)
+        return;
+    if (--d->updateDepth == 0) {
+        d->deferredTimer.stop();
+        d->flushUpdates();
     }
-
-    /*! \todo remove publisher from HUD when the API is added */
-    contextData.remove(context);
 }
 
-void
-ActionManager::Private::contextActionsChanged()
+bool
+ActionManager::deferredUpdates() const
 {
-    ActionContext *context = qobject_cast<ActionContext *>(sender());
-    Q_ASSERT(context != 0);
-    updateContext(context);
+    return d->deferredUpdates;
 }
 
 void
-ActionManager::Private::setActiveContext(ActionContext *context)
+ActionManager::setDeferredUpdates(bool value)
 {
-    if (context == globalContext) {
-        // global context is always active.
+    if (d->deferredUpdates == value)
         return;
+    d->deferredUpdates = value;
+    if (!value && d->deferredTimer.isActive()) {
+        // apply the pending changes right away
+        d->deferredTimer.stop();
+        if (d->updateDepth == 0)
+            d->flushUpdates();
     }
-    if (!context->active()) {
-        // activate the context
-        context->setActive(true);
-    }
-    if (activeLocalContext == 0) {
-        activeLocalContext = context;
-        updateActionGroup();
-        hud_manager_switch_window_context(hudManager,
-                                          contextData[context].publisher);
-    } else if (activeLocalContext == context) {
-        // already active one.
-        return;
+    emit deferredUpdatesChanged(value);
+}
+
+/*!
+ * \param operation the kind of API operation that caused the traffic
+ * \param counter the kind of D-Bus traffic
+ *
+ * Returns the number of times the manager caused the given kind of
+ * D-Bus traffic while handling the given kind of operation since the
+ * manager was created or resetTrafficCounters() was called.
+ *
+ * The counters are meant for finding regressions in the message volume.
+ * Setting the UNITY_ACTION_TRAFFIC_DUMP environment variable to an interval
+ * in milliseconds prints all of the counters periodically.
+ *
+ * \note With batched or deferred updates the traffic happens when the
+ *       changes are applied and is counted for ActionManager::FlushOperation.
+ */
+int
+ActionManager::trafficCount(Operation operation, Counter counter) const
+{
+    Q_ASSERT(operation >= 0 && operation < OperationCount);
+    Q_ASSERT(counter >= 0 && counter < CounterCount);
+    return d->traffic[operation][counter];
+}
+
+/*!
+ * Sets all the traffic counters to zero.
+ *
+ * \see trafficCount()
+ */
+void
+ActionManager::resetTrafficCounters()
+{
+    memset(d->traffic, 0, sizeof(d->traffic));
+}
+
+/*!
+ * Returns the time in microseconds the most recently destroyed
+ * ActionManager spent flushing the session bus, or -1 if no manager
+ * has flushed the bus yet.
+ *
+ * The flush is bounded by a deadline which the UNITY_ACTION_FLUSH_TIMEOUT
+ * environment variable can change, see ActionManager.
+ */
+qint64
+ActionManager::shutdownFlushTime()
+{
+    return lastShutdownFlushTime;
+}
+
+
+/************************************************************************/
+/*                         Traffic accounting                           */
+/************************************************************************/
+
+void
+ActionManager::Private::dumpTraffic()
+{
+    static const char *operations[ActionManager::OperationCount] = {
+        "action", "context-switch", "property", "parameter", "flush"
+    };
+    for (int i = 0; i < ActionManager::OperationCount; i++) {
+        qDebug("unity-action traffic: %-14s inserts: %d removes: %d "
+               "enabled: %d attributes: %d descriptions: %d states: %d",
+               operations[i],
+               traffic[i][ActionManager::ActionGroupInsert],
+               traffic[i][ActionManager::ActionGroupRemove],
+               traffic[i][ActionManager::EnabledChange],
+               traffic[i][ActionManager::AttributeSet],
+               traffic[i][ActionManager::DescriptionAdd],
+               traffic[i][ActionManager::StateChange]);
+    }
+}
+
+/************************************************************************/
+/*                         Session bus                                  */
+/************************************************************************/
+
+void
+ActionManager::Private::connectHud()
+{
+    OperationScope scope(this, ActionManager::ActionOperation);
+    const char *appid = getenv("APP_ID");
+    if (appid == 0) {
+        qWarning("%s:\n"
+                 "\tCould not determine application identifier. HUD will not work properly.\n"
+                 "\tProvide your application identifier in $APP_ID environment variable.",
+                 __PRETTY_FUNCTION__);
+        appid = "unknown";
+    }
+    hudManager = hud_manager_new(appid);
+
+    // publish the contexts created while waiting for the session bus
+    QHash<ActionContext *, ContextData>::iterator i;
+    for (i = contextData.begin(); i != contextData.end(); ++i) {
+        ContextData &cdata = i.value();
+        cdata.publisher = createPublisher();
+        cdata.hudActions.clear();
+        cdata.tombstones = 0;
+    }
+    foreach (ActionContext *context, contextData.keys()) {
+        updateHudContext(context);
+    }
+}
+
+void
+ActionManager::Private::exportActionGroup()
+{
+    if (sessionBus == 0)
+        return;
+
+    GError *error = NULL;
+    exportId = g_dbus_connection_export_action_group(sessionBus,
+                                                     UNITY_ACTION_EXPORT_PATH,
+                                                     G_ACTION_GROUP(actionGroup),
+                                                     &error);
+    if (exportId == 0) {
+        Q_ASSERT(error != NULL);
+        qWarning("%s:\n"
+                 "\tCould not export the main action group. Actions will not be available through D-Bus.\n"
+                 "\tReason: %s",
+                 __PRETTY_FUNCTION__,
+                 error->message);
+        g_error_free(error);
+        error = NULL;
+    }
+}
+
+void
+ActionManager::Private::flushSessionBus()
+{
+    Q_ASSERT(sessionBus != 0);
+
+    bool ok;
+    int timeout = qgetenv("UNITY_ACTION_FLUSH_TIMEOUT").toInt(&ok);
+    if (!ok)
+        timeout = UNITY_ACTION_FLUSH_TIMEOUT;
+    if (timeout < 0) {
+        g_dbus_connection_flush_sync(sessionBus, NULL, NULL);
+        return;
+    }
+
+    /* Flush in a thread of its own and wait for it until the deadline.
+     * Nothing has to be dispatched for the flush to complete, so if the
+     * deadline passes the thread finishes the flush on its own and
+     * releases the state and the bus.
+     */
+    FlushState *state = new FlushState;
+    state->bus = (GDBusConnection *)g_object_ref(sessionBus);
+    g_mutex_init(&state->mutex);
+    g_cond_init(&state->cond);
+    state->finished = false;
+    state->refs = 2;
+    g_thread_unref(g_thread_new("unity-action-flush", flush_thread, state));
+
+    gint64 deadline = g_get_monotonic_time() + timeout * G_TIME_SPAN_MILLISECOND;
+    g_mutex_lock(&state->mutex);
+    while (!state->finished) {
+        if (!g_cond_wait_until(&state->cond, &state->mutex, deadline))
+            break;
+    }
+    bool finished = state->finished;
+    g_mutex_unlock(&state->mutex);
+    flush_state_unref(state);
+
+    if (!finished) {
+        qWarning("%s:\n"
+                 "\tFlushing the session bus did not finish in %d ms.",
+                 __PRETTY_FUNCTION__,
+                 timeout);
+    }
+}
+
+void
+ActionManager::Private::bus_acquired(GObject      *source,
+                                     GAsyncResult *result,
+                                     gpointer      user_data)
+{
+    Q_UNUSED(source);
+
+    GError *error = NULL;
+    GDBusConnection *bus = g_bus_get_finish(result, &error);
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        // the manager is already gone
+        g_error_free(error);
+        return;
+    }
+
+    Private *that = (Private *)user_data;
+    g_clear_object(&that->busCancellable);
+    if (error != NULL) {
+        qWarning("%s:\n"
+                 "\tCould not get session bus. Actions will not be available through D-Bus.\n"
+                 "\tReason: %s",
+                 __PRETTY_FUNCTION__,
+                 error->message);
+        g_error_free(error);
+        error = NULL;
+    }
+    that->sessionBus = bus;
+
+    that->connectHud();
+    that->switchHudContext();
+    that->exportActionGroup();
+}
+
+/************************************************************************/
+/*                         ActionContext                                */
+/************************************************************************/
+
+void
+ActionManager::Private::createContext(ActionContext *context)
+{
+    Q_ASSERT(!contextData.contains(context));
+
+    ContextData cdata;
+    // created in connectHud() if still waiting for the session bus
+    if (hudManager != 0)
+        cdata.publisher = createPublisher();
+    contextData.insert(context, cdata);
+}
+
+HudActionPublisher *
+ActionManager::Private::createPublisher()
+{
+    static int id = 0;
+
+    /* create a new HUD context */
+    HudActionPublisher *publisher;
+    publisher = hud_action_publisher_new(HUD_ACTION_PUBLISHER_ALL_WINDOWS,
+                                         qPrintable(QString("action_context_%1").arg(id++)));
+    hud_action_publisher_add_action_group(publisher,
+                                          "hud",
+                                          UNITY_ACTION_EXPORT_PATH);
+    hud_manager_add_actions(hudManager, publisher);
+    return publisher;
+}
+
+void
+ActionManager::Private::destroyContext(ActionContext *context)
+{
+    OperationScope scope(this, ActionManager::ActionOperation);
+    Q_ASSERT(contextData.contains(context));
+    ContextData &cdata = contextData[context];
+
+    QSet<Action *> actions = cdata.actions;
+    cdata.actions.clear();
+    foreach (Action *action, actions) {
+        releaseAction(context, action);
+    }
+
+    // the exports of the context leave the action group
+    if (exportsVisible(context)) {
+        QHash<QByteArray, GSimpleAction *>::const_iterator i;
+        for (i = cdata.exports.constBegin(); i != cdata.exports.constEnd(); ++i) {
+            dirtyExportNames.insert(i.key());
+        }
+    }
+    if (context == overlayContext)
+        overlayContext = 0;
+
+    if (cdata.publisher != 0)
+        hud_manager_remove_actions(hudManager, cdata.publisher);
+    contextData.remove(context);
+    dirtyContexts.remove(context);
+    emitActionChanges();
+}
+
+void
+ActionManager::Private::contextActionsAdded(const QList<Action *> &actions)
+{
+    ActionContext *context = qobject_cast<ActionContext *>(sender());
+    Q_ASSERT(context != 0);
+    Q_ASSERT(contextData.contains(context));
+    ContextData &cdata = contextData[context];
+    foreach (Action *action, actions) {
+        cdata.addedActions.insert(action);
+        cdata.removedActions.remove(action);
+    }
+    scheduleContextUpdate(context);
+}
+
+void
+ActionManager::Private::contextActionsRemoved(const QList<Action *> &actions)
+{
+    ActionContext *context = qobject_cast<ActionContext *>(sender());
+    Q_ASSERT(context != 0);
+    Q_ASSERT(contextData.contains(context));
+    ContextData &cdata = contextData[context];
+    foreach (Action *action, actions) {
+        cdata.removedActions.insert(action);
+        cdata.addedActions.remove(action);
+    }
+    scheduleContextUpdate(context);
+}
+
+void
+ActionManager::Private::scheduleContextUpdate(ActionContext *context)
+{
+    OperationScope scope(this, ActionManager::ActionOperation);
+    if (deferUpdate()) {
+        dirtyContexts.insert(context);
+        return;
+    }
+    updateContext(context);
+}
+
+void
+ActionManager::Private::setActiveContext(ActionContext *context)
+{
+    OperationScope scope(this, ActionManager::ContextSwitchOperation);
+    if (context == globalContext) {
+        // global context is always active.
+        return;
+    }
+    if (!context->active()) {
+        // activate the context
+        context->setActive(true);
+    }
+    if (activeLocalContext == 0) {
+        activeLocalContext = context;
+        switchActionGroup();
+        switchHudContext();
+    } else if (activeLocalContext == context) {
+        // already active one.
+        return;
     } else {
         // deactivate the old active one.
         ActionContext *old = activeLocalContext;
         activeLocalContext = context;
         old->setActive(false);
-        updateActionGroup();
-        hud_manager_switch_window_context(hudManager,
-                                          contextData[context].publisher);
+        switchActionGroup();
+        switchHudContext();
     }
 }
 
 void
 ActionManager::Private::contextActiveChanged(bool value)
 {
+    OperationScope scope(this, ActionManager::ContextSwitchOperation);
     ActionContext *context = qobject_cast<ActionContext *>(sender());
     Q_ASSERT(context != 0);
     Q_ASSERT(contextData.contains(context));
@@ -656,84 +1598,287 @@ ActionManager::Private::contextActiveChanged(bool value)
             // the active context was deactivated
             // this means that only the global context is active
             activeLocalContext = 0;
-            updateActionGroup();
-            hud_manager_switch_window_context(hudManager,
-                                              contextData[globalContext].publisher);
+            switchActionGroup();
+            switchHudContext();
         }
     }
 }
 
 void
-ActionManager::Private::updateActionGroup()
+ActionManager::Private::syncActionGroup()
 {
-    // update the exported action group according to
-    // current actions in global context and
-    // in the active local context
+    if (deferUpdate()) {
+        actionGroupDirty = true;
+        return;
+    }
+    updateActionGroup();
+}
+
+void
+ActionManager::Private::switchHudContext()
+{
+    if (deferUpdate()) {
+        hudContextDirty = true;
+        return;
+    }
+    if (hudManager == 0) {
+        // connectHud() switches to the current context
+        return;
+    }
+    ActionContext *context = activeLocalContext;
+    if (context == 0)
+        context = globalContext;
+    Q_ASSERT(contextData.contains(context));
+    hud_manager_switch_window_context(hudManager,
+                                      contextData[context].publisher);
+}
+
+bool
+ActionManager::Private::deferUpdate()
+{
+    if (updatesSuspended())
+        return true;
+    if (!deferredUpdates)
+        return false;
+    deferredTimer.start();
+    return true;
+}
+
+void
+ActionManager::Private::deferredFlush()
+{
+    // an open beginUpdate() batch is reconciled by endUpdate()
+    if (updateDepth == 0)
+        flushUpdates();
+}
 
-    QSet<Action *> globalActions = globalContext->allActions();
-    QSet<Action *> localActions;
-    if (activeLocalContext)
-        localActions = activeLocalContext->actions();
-    QSet<Action *> currentActions = globalActions + localActions;
+void
+ActionManager::Private::flushUpdates()
+{
+    OperationScope scope(this, ActionManager::FlushOperation);
+    /* Keep the updates suspended while reconciling so that the
+     * action group and the HUD context are updated only once at the end.
+     */
+    updateDepth++;
 
-    /*
-     * First remove the actions that are not part of the current active ones
+    /* The HUD contexts of the local contexts are a union of the global and
+     * the local one, so all the actions have to be known to the manager
+     * before any of the contexts is updated.
      */
-    QSet<gchar *> removedActionNames;
-    gchar **oldActionNames = g_action_group_list_actions(G_ACTION_GROUP(actionGroup));
-    for (gchar **actionName = oldActionNames; *actionName != 0; actionName++) {
-        bool found = false;
-        foreach (Action * action, currentActions) {
-            Q_ASSERT(actionData.contains(action));
-            const ActionData &adata = actionData[action];
-            if (g_strcmp0(g_action_get_name(G_ACTION(adata.gaction)), *actionName) == 0) {
-                found = true;
-                break;
-            }
-            // also check for parameter gactions
-            foreach (const ParameterData &pdata, adata.params) {
-                if (g_strcmp0(g_action_get_name(G_ACTION(pdata.gaction)), *actionName) == 0) {
-                    found = true;
-                    break;
+    foreach (ActionContext *context, dirtyContexts) {
+        const ContextData &cdata = contextData[context];
+        QList<const QSet<Action *> *> sources;
+        if (cdata.fullUpdate) {
+            sources << &context->constActions();
+            if (context == globalContext)
+                sources << &globalContext->builtInActions();
+        } else {
+            sources << &cdata.addedActions;
+        }
+        foreach (const QSet<Action *> *source, sources) {
+            foreach (Action *action, *source) {
+                if (!actionData.contains(action)) {
+                    createAction(action);
                 }
             }
-            if (found)
-                break;
         }
-        if (!found)
-            removedActionNames.insert(*actionName);
     }
-    foreach (gchar *name, removedActionNames) {
-        g_simple_action_group_remove(actionGroup, name);
+
+    while (!dirtyContexts.isEmpty()) {
+        // global context first, see above
+        if (dirtyContexts.remove(globalContext)) {
+            updateContext(globalContext);
+            continue;
+        }
+        ActionContext *context = *dirtyContexts.begin();
+        dirtyContexts.remove(context);
+        updateContext(context);
+    }
+
+    // only actions still known by the manager can be in the dirty sets
+    foreach (Action *action, dirtyActions) {
+        updateActionsWhenNameOrTypeHaveChanged(action);
+    }
+    dirtyActions.clear();
+
+    QHash<Action *, int>::const_iterator i;
+    for (i = dirtyProperties.constBegin(); i != dirtyProperties.constEnd(); ++i) {
+        updateActionProperties(i.key(), actionData[i.key()], i.value());
+    }
+    dirtyProperties.clear();
+
+    foreach (Action *action, dirtyParameters) {
+        PreviewAction *previewAction = qobject_cast<PreviewAction *>(action);
+        Q_ASSERT(previewAction != 0);
+        ActionData &adata = actionData[action];
+        updatePreviewActionParameters(previewAction, adata);
+        updateParameterMenu(previewAction, adata);
+        invalidateExports(action);
+        actionGroupDirty = true;
+    }
+    dirtyParameters.clear();
+
+    updateDepth--;
+    emitActionChanges();
+
+    if (actionGroupDirty) {
+        actionGroupDirty = false;
+        updateActionGroup();
+    }
+    if (hudContextDirty) {
+        hudContextDirty = false;
+        switchHudContext();
     }
-    removedActionNames.clear();
-    g_strfreev(oldActionNames);
+}
 
+void
+ActionManager::Private::collectExports(ActionContext *context)
+{
+    Q_ASSERT(contextData.contains(context));
+    ContextData &cdata = contextData[context];
+    if (cdata.staleExports.isEmpty())
+        return;
 
-    // NOTE: it is important that we reinsert all the actions so that
-    //       the GActions update after parameter types have changed
+    QSet<Action *> stale;
+    stale.swap(cdata.staleExports);
+    bool visible = exportsVisible(context);
+    foreach (Action *action, stale) {
+        removeActionExports(context, action);
+        if (!cdata.actions.contains(action))
+            continue;
 
-    // then update all the global actions
-    foreach (Action * action, globalActions) {
         Q_ASSERT(actionData.contains(action));
-        const ActionData &adata = actionData[action];
-        g_simple_action_group_insert(actionGroup, G_ACTION(adata.gaction));
+        ActionData &adata = actionData[action];
+        if (adata.gaction == 0)
+            adata.gaction = createGAction(action, adata);
+        QHash<QByteArray, GSimpleAction *> entries;
+        entries.insert(g_action_get_name(G_ACTION(adata.gaction)), adata.gaction);
+        // also export the parameter gactions
         foreach (const ParameterData &pdata, adata.params) {
-            g_simple_action_group_insert(actionGroup, G_ACTION(pdata.gaction));
+            entries.insert(g_action_get_name(G_ACTION(pdata.gaction)), pdata.gaction);
+        }
+        QHash<QByteArray, GSimpleAction *>::const_iterator i;
+        for (i = entries.constBegin(); i != entries.constEnd(); ++i) {
+            cdata.exports.insert(i.key(), i.value());
+            if (visible)
+                dirtyExportNames.insert(i.key());
         }
+        cdata.actionExports.insert(action, entries);
     }
+}
 
-    // and finally update the local actions.
-    // if a local action has the same name than
-    // a global one it will replace the global one
-    foreach (Action * action, localActions) {
-        Q_ASSERT(actionData.contains(action));
-        const ActionData &adata = actionData[action];
-        g_simple_action_group_insert(actionGroup, G_ACTION(adata.gaction));
-        foreach (const ParameterData &pdata, adata.params) {
-            g_simple_action_group_insert(actionGroup, G_ACTION(pdata.gaction));
+void
+ActionManager::Private::removeActionExports(ActionContext *context, Action *action)
+{
+    Q_ASSERT(contextData.contains(context));
+    ContextData &cdata = contextData[context];
+    cdata.staleExports.remove(action);
+    QHash<QByteArray, GSimpleAction *> entries = cdata.actionExports.take(action);
+    bool visible = exportsVisible(context);
+    QHash<QByteArray, GSimpleAction *>::const_iterator i;
+    for (i = entries.constBegin(); i != entries.constEnd(); ++i) {
+        // leave the entry of another action with the same name alone
+        if (cdata.exports.value(i.key(), 0) != i.value())
+            continue;
+        cdata.exports.remove(i.key());
+        if (visible)
+            dirtyExportNames.insert(i.key());
+    }
+}
+
+void
+ActionManager::Private::invalidateExports(Action *action)
+{
+    Q_ASSERT(actionData.contains(action));
+    foreach (ActionContext *context, actionData[action].contexts) {
+        contextData[context].staleExports.insert(action);
+    }
+}
+
+void
+ActionManager::Private::exportAction(const QByteArray &name, GSimpleAction *gaction)
+{
+    /* Insert only the gactions whose instance has changed.
+     * Each insert makes GDBus emit a change signal, so we must not
+     * reinsert the ones that are already exported. The gaction of an
+     * action gets replaced when its name or parameter type changes.
+     */
+    GSimpleAction *exported = exportedActions.value(name, 0);
+    if (exported == gaction)
+        return;
+    if (gaction == 0) {
+        g_simple_action_group_remove(actionGroup, name.constData());
+        countTraffic(ActionManager::ActionGroupRemove);
+        exportedActions.remove(name);
+    } else {
+        g_simple_action_group_insert(actionGroup, G_ACTION(gaction));
+        countTraffic(ActionManager::ActionGroupInsert);
+        // keep a reference so that the pointer comparison above stays valid
+        exportedActions.insert(name, (GSimpleAction *)g_object_ref(gaction));
+    }
+    if (exported != 0)
+        g_object_unref(exported);
+}
+
+void
+ActionManager::Private::updateActionGroup()
+{
+    // update the exported action group according to
+    // current actions in global context and
+    // in the active local context
+
+    /* Switching the active local context replaces the whole overlay:
+     * the names of the old one have to fall back to the global actions
+     * and the names of the new one have to be applied.
+     */
+    if (overlayContext != activeLocalContext) {
+        QHash<QByteArray, GSimpleAction *>::const_iterator i;
+        if (overlayContext != 0) {
+            const ContextData &cdata = contextData[overlayContext];
+            for (i = cdata.exports.constBegin(); i != cdata.exports.constEnd(); ++i) {
+                dirtyExportNames.insert(i.key());
+            }
+        }
+        overlayContext = activeLocalContext;
+        if (overlayContext != 0) {
+            collectExports(overlayContext);
+            const ContextData &cdata = contextData[overlayContext];
+            for (i = cdata.exports.constBegin(); i != cdata.exports.constEnd(); ++i) {
+                dirtyExportNames.insert(i.key());
+            }
         }
     }
+
+    // only the actions that changed are collected again
+    collectExports(globalContext);
+    if (overlayContext != 0)
+        collectExports(overlayContext);
+
+    /* If a local action has the same name than a global one
+     * it will replace the global one.
+     */
+    const QHash<QByteArray, GSimpleAction *> &globalExports = contextData[globalContext].exports;
+    const QHash<QByteArray, GSimpleAction *> *overlay = 0;
+    if (overlayContext != 0)
+        overlay = &contextData[overlayContext].exports;
+    foreach (const QByteArray &name, dirtyExportNames) {
+        GSimpleAction *gaction = 0;
+        if (overlay != 0)
+            gaction = overlay->value(name, 0);
+        if (gaction == 0)
+            gaction = globalExports.value(name, 0);
+        exportAction(name, gaction);
+    }
+    dirtyExportNames.clear();
+}
+
+void
+ActionManager::Private::switchActionGroup()
+{
+    /* The global exports stay the same, updateActionGroup() only touches
+     * the names of the previous and the new overlay.
+     */
+    syncActionGroup();
 }
 
 void
@@ -742,16 +1887,28 @@ ActionManager::Private::updateContext(ActionContext *context)
     Q_ASSERT(contextData.contains(context));
     ContextData &cdata = contextData[context];
 
-    QSet<Action *> oldActions = cdata.actions;
-    QSet<Action *> currentActions;
-    if(context == globalContext) {
-        currentActions = globalContext->allActions();
+    QSet<Action *> newActions;
+    QSet<Action *> removedActions;
+    bool fullUpdate = cdata.fullUpdate;
+    if (fullUpdate) {
+        QSet<Action *> currentActions;
+        if(context == globalContext) {
+            currentActions = globalContext->allActions();
+        } else {
+            currentActions = context->actions();
+        }
+        newActions     = currentActions - cdata.actions;
+        removedActions = cdata.actions - currentActions;
+        cdata.fullUpdate = false;
     } else {
-        currentActions = context->actions();
+        // apply the changes the context has reported
+        newActions     = cdata.addedActions - cdata.actions;
+        removedActions = cdata.removedActions & cdata.actions;
     }
-    QSet<Action *> removedActions = oldActions - currentActions;
+    cdata.addedActions.clear();
+    cdata.removedActions.clear();
 
-    foreach (Action *action, currentActions) {
+    foreach (Action *action, newActions) {
         // Make sure the manager knows about all of the actions
         if (!actionData.contains(action)) {
             createAction(action);
@@ -762,19 +1919,21 @@ ActionManager::Private::updateContext(ActionContext *context)
          * This has to be separate from making sure the action is known to manager
          * because some other context might have introduced the same action before already.
          */
-        if (!cdata.actions.contains(action)) {
-            /* oldActions still contain the original old ones
-             * so it's safe to modify cdata.actions here
-             */
-            cdata.actions.insert(action);
-        }
+        cdata.actions.insert(action);
+        actionData[action].contexts.insert(context);
+        // collected lazily, see collectExports()
+        cdata.staleExports.insert(action);
+    }
+    cdata.actions.subtract(removedActions);
+    foreach (Action *action, removedActions) {
+        removeActionExports(context, action);
     }
 
 
     if (context == globalContext || context == activeLocalContext) {
         // a context that affects the actionGroup have changed.
         // update the group.
-        updateActionGroup();
+        syncActionGroup();
     }
 
 
@@ -783,61 +1942,160 @@ ActionManager::Private::updateContext(ActionContext *context)
         // if global context changes we have to update all the local ones, too
         // as a HUD context is a union of the global and a local context
         foreach(ActionContext *localContext, localContexts) {
-            updateHudContext(localContext, oldActions);
+            if (fullUpdate)
+                updateHudContext(localContext);
+            else
+                updateHudContext(localContext, newActions, removedActions);
         }
     }
-    updateHudContext(context, oldActions);
+    if (fullUpdate)
+        updateHudContext(context);
+    else
+        updateHudContext(context, newActions, removedActions);
 
 
     // finally clean up the removed actions
     foreach (Action *action, removedActions) {
+        releaseAction(context, action);
+    }
+    emitActionChanges();
+}
 
-        // remove the action from this context
-        cdata.actions.remove(action);
-
-        // when actions are removed from this context
-        // we can't destroy their ActionData if any of the
-        // other contexts contain the action.
-        bool inUse = false;
-        foreach (const ContextData &cdata, contextData) {
-            if (cdata.actions.contains(action)) {
-                inUse = true;
-                break;
-            }
+void
+ActionManager::Private::releaseAction(ActionContext *context, Action *action)
+{
+    Q_ASSERT(actionData.contains(action));
+    ActionData &adata = actionData[action];
+    adata.contexts.remove(context);
+
+    // when actions are removed from a context
+    // we can't destroy their ActionData if any of the
+    // other contexts contain the action.
+    if (adata.contexts.isEmpty()) {
+        destroyAction(action);
+    }
+}
+
+void
+ActionManager::Private::updateHudContext(ActionContext *context)
+{
+    Q_ASSERT(contextData.contains(context));
+    ContextData &cdata = contextData[context];
+
+    // a HUD context is a union of the global and the local context
+    QSet<Action *> currentActions = cdata.actions + contextData[globalContext].actions;
+    updateHudContext(context,
+                     currentActions - cdata.hudActions,
+                     cdata.hudActions - currentActions);
+}
+
+/* Applies the changes of the context or the global context to the
+ * HUD context. An added action already in the HUD context and a removed
+ * action still part of the union are left as they are.
+ */
+void
+ActionManager::Private::updateHudContext(ActionContext *context,
+                                         const QSet<Action *> &newActions,
+                                         const QSet<Action *> &removedActions)
+{
+    Q_ASSERT(contextData.contains(context));
+    ContextData &cdata = contextData[context];
+    const ContextData &gdata = contextData[globalContext];
+
+    int removed = 0;
+    foreach (Action *action, removedActions) {
+        if (cdata.actions.contains(action) || gdata.actions.contains(action))
+            continue;
+        if (!cdata.hudActions.remove(action))
+            continue;
+        if (cdata.publisher == 0) {
+            // published in connectHud()
+            continue;
+        }
+        if (!actionData.contains(action)) {
+            // destroyed together with the old globalContext
+            continue;
+        }
+        ActionData &adata = actionData[action];
+        /* Removing descriptions is not supported in libhud at the moment.
+         * For now, let's just empty the label and that will hide the
+         * action from the HUD.
+         */
+        hud_action_description_set_attribute_value(adata.desc,
+                                                   G_MENU_ATTRIBUTE_LABEL,
+                                                   g_variant_new_string(""));
+        adata.cachedProperties &= ~ActionData::Text;
+        countTraffic(ActionManager::AttributeSet);
+        removed++;
+    }
+    foreach (Action *action, newActions) {
+        if (cdata.hudActions.contains(action))
+            continue;
+        cdata.hudActions.insert(action);
+        if (cdata.publisher == 0) {
+            // published in connectHud()
+            continue;
         }
-        if (!inUse) {
-            destroyAction(action);
+        Q_ASSERT(actionData.contains(action));
+        ActionData &adata = actionData[action];
+        if (adata.desc == 0) {
+            adata.desc = createDescription(action, adata);
+        } else if (!(adata.cachedProperties & ActionData::Text)) {
+            // give back the label emptied when the action was removed
+            int count = updateDescriptionAttributes(action, adata, adata.desc, ActionData::Text);
+            countTraffic(ActionManager::AttributeSet, count);
         }
+        hud_action_publisher_add_description(cdata.publisher, adata.desc);
+        countTraffic(ActionManager::DescriptionAdd);
     }
+    cdata.tombstones += removed;
+    retireTombstones(context);
+}
+
+QList<ActionContext *>
+ActionManager::Private::hudContexts(Action *action)
+{
+    Q_ASSERT(actionData.contains(action));
+    const ActionData &adata = actionData[action];
+    // actions of the global context are part of every HUD context
+    if (adata.contexts.contains(globalContext))
+        return contextData.keys();
+    return adata.contexts.toList();
 }
 
 void
-ActionManager::Private::updateHudContext(ActionContext *context, QSet<Action *> oldActions)
+ActionManager::Private::retireTombstones(ActionContext *context)
 {
     Q_ASSERT(contextData.contains(context));
-    const ContextData &cdata = contextData[context];
-
-
-    QSet<Action *> currentActions = context->actions() + globalContext->allActions();
-    QSet<Action *> newActions     = currentActions - oldActions;
-    QSet<Action *> removedActions = oldActions - currentActions;
+    ContextData &cdata = contextData[context];
+    if (cdata.publisher == 0 ||
+        cdata.tombstones < UNITY_ACTION_HUD_TOMBSTONE_LIMIT ||
+        cdata.tombstones < cdata.hudActions.count()) {
+        return;
+    }
 
-    foreach (Action *action, newActions) {
+    /* The hidden descriptions stay in the publisher as libhud can not
+     * remove them. Once they outnumber the live ones replace the publisher
+     * with a new one containing only the live descriptions.
+     */
+    HudActionPublisher *old = cdata.publisher;
+    cdata.publisher = createPublisher();
+    foreach (Action *action, cdata.hudActions) {
         Q_ASSERT(actionData.contains(action));
-        const ActionData &adata = actionData[action];
-        hud_action_publisher_add_description(cdata.publisher, adata.desc);
+        hud_action_publisher_add_description(cdata.publisher,
+                                             actionData[action].desc);
+        countTraffic(ActionManager::DescriptionAdd);
     }
-    foreach (Action *action, removedActions) {
-        Q_ASSERT(actionData.contains(action));
-        const ActionData &adata = actionData[action];
-        /* Removing descriptions is not supported in libhud at the moment.
-         * For now, let's just empty the label and that will hide the
-         * action from the HUD.
-         */
-        hud_action_description_set_attribute_value(adata.desc,
-                                                   G_MENU_ATTRIBUTE_LABEL,
-                                                   g_variant_new_string(""));
+    cdata.tombstones = 0;
+
+    ActionContext *current = activeLocalContext;
+    if (current == 0)
+        current = globalContext;
+    if (context == current) {
+        hud_manager_switch_window_context(hudManager, cdata.publisher);
     }
+    hud_manager_remove_actions(hudManager, old);
+    g_object_unref(old);
 }
 
 void
@@ -869,7 +2127,10 @@ ActionManager::Private::contextDestroyed(QObject *obj)
         createContext(globalContext);
         globalContext->addBuiltInAction(quitAction.data());
         updateContext(globalContext);
-        connect(globalContext, SIGNAL(actionsChanged()), this, SLOT(contextActionsChanged()));
+        connect(globalContext, SIGNAL(actionsAdded(QList<unity::action::Action*>)),
+                this, SLOT(contextActionsAdded(QList<unity::action::Action*>)));
+        connect(globalContext, SIGNAL(actionsRemoved(QList<unity::action::Action*>)),
+                this, SLOT(contextActionsRemoved(QList<unity::action::Action*>)));
         connect(globalContext, SIGNAL(activeChanged(bool)), this, SLOT(contextActiveChanged(bool)));
         connect(globalContext, SIGNAL(destroyed(QObject*)), this, SLOT(contextDestroyed(QObject *)));
 
@@ -879,6 +2140,54 @@ ActionManager::Private::contextDestroyed(QObject *obj)
     q->removeLocalContext(ctx);
 }
 
+void
+ActionManager::Private::actionDestroyed(QObject *obj)
+{
+    /* When updates are batched the contexts remove the destroyed action
+     * only from their own sets and the manager would hold on to the
+     * dangling pointer until the batch ends. Drop the action right away.
+     */
+    Action *action = (Action *)obj;
+    OperationScope scope(this, ActionManager::ActionOperation);
+    if (action == 0 || !updatesSuspended() || !actionData.contains(action)) {
+        return;
+    }
+
+    QList<ActionContext *> affectedHudContexts = hudContexts(action);
+    foreach (ActionContext *context, affectedHudContexts) {
+        ContextData &cdata = contextData[context];
+        if (cdata.hudActions.remove(action))
+            cdata.tombstones++;
+    }
+
+    foreach (ActionContext *context, actionData[action].contexts) {
+        removeActionExports(context, action);
+        contextData[context].actions.remove(action);
+    }
+    // forget the changes still pending for the contexts
+    QHash<ActionContext *, ContextData>::iterator i;
+    for (i = contextData.begin(); i != contextData.end(); ++i) {
+        i.value().addedActions.remove(action);
+        i.value().removedActions.remove(action);
+    }
+
+    // hide the action from the HUD like updateHudContext() does
+    if (actionData[action].desc != 0) {
+        hud_action_description_set_attribute_value(actionData[action].desc,
+                                                   G_MENU_ATTRIBUTE_LABEL,
+                                                   g_variant_new_string(""));
+        actionData[action].cachedProperties &= ~ActionData::Text;
+        countTraffic(ActionManager::AttributeSet);
+    }
+    actionGroupDirty = true;
+    destroyAction(action);
+    emitActionChanges();
+
+    foreach (ActionContext *context, affectedHudContexts) {
+        retireTombstones(context);
+    }
+}
+
 /************************************************************************/
 /*                              Action                                  */
 /************************************************************************/
@@ -888,60 +2197,88 @@ ActionManager::Private::action_activated(GSimpleAction *simpleaction,
                                          GVariant      *parameter,
                                          gpointer       user_data)
 {
-    Action *action = qobject_cast<Action *>((QObject *)user_data);
-    Q_ASSERT(action != 0);
-    if (action == 0) {
-        return;
-    }
+    Q_UNUSED(simpleaction);
+    ActivationHandler *handler = (ActivationHandler *)user_data;
+    Q_ASSERT(handler != 0);
 
-    if (g_action_get_parameter_type(G_ACTION(simpleaction)) == NULL) {
-        action->trigger();
+    /* The gaction was created with the parameter type of the action,
+     * so the value is decoded straight into the typed trigger, which
+     * only boxes it into a QVariant if triggered() is connected.
+     */
+    switch (handler->kind) {
+    case ActivationHandler::TriggerNone:
+        handler->action->triggerNone();
         return;
-
-    } else if (g_variant_is_of_type(parameter, G_VARIANT_TYPE_STRING)) {
-        PreviewAction *previewAction = qobject_cast<PreviewAction *>(action);
-        if (previewAction) {
-            QString state(g_variant_get_string(parameter, NULL));
-            if (state == "start") {
-                emit previewAction->started();
-                return;
-            } else if (state == "end") {
-                // just skip for now
-                return;
-            } else if (state == "commit") {
-                emit previewAction->trigger();
-                return;
-            } else if (state == "reset") {
-                emit previewAction->resetted();
-                return;
-            } else if (state == "cancel") {
-                emit previewAction->cancelled();
-                return;
-            } else {
-                qWarning("Unknown PreviewAction state: %s", qPrintable(state));
-            }
-        } else {
-            Q_ASSERT(action->parameterType() == Action::String);
-            QString arg(g_variant_get_string(parameter, NULL));
-            action->trigger(QVariant(arg));
+    case ActivationHandler::TriggerString:
+        if (g_variant_is_of_type(parameter, G_VARIANT_TYPE_STRING)) {
+            handler->action->triggerString(QString::fromUtf8(g_variant_get_string(parameter, NULL)));
+            return;
         }
-    } else if (g_variant_is_of_type(parameter, G_VARIANT_TYPE_INT32)) {
-        Q_ASSERT(action->parameterType() == Action::Integer);
-        int arg = g_variant_get_int32(parameter);
-        action->trigger(QVariant(arg));
-
-    } else if (g_variant_is_of_type(parameter, G_VARIANT_TYPE_BOOLEAN)) {
-        Q_ASSERT(action->parameterType() == Action::Bool);
-        bool arg = g_variant_get_boolean(parameter);
-        action->trigger(QVariant(arg));
+        break;
+    case ActivationHandler::TriggerInt:
+        if (g_variant_is_of_type(parameter, G_VARIANT_TYPE_INT32)) {
+            handler->action->triggerInt(g_variant_get_int32(parameter));
+            return;
+        }
+        break;
+    case ActivationHandler::TriggerBool:
+        if (g_variant_is_of_type(parameter, G_VARIANT_TYPE_BOOLEAN)) {
+            handler->action->triggerBool(g_variant_get_boolean(parameter));
+            return;
+        }
+        break;
+    case ActivationHandler::TriggerReal:
+        if (g_variant_is_of_type(parameter, G_VARIANT_TYPE_DOUBLE)) {
+            handler->action->triggerReal(g_variant_get_double(parameter));
+            return;
+        }
+        break;
+    case ActivationHandler::Preview:
+        if (g_variant_is_of_type(parameter, G_VARIANT_TYPE_STRING)) {
+            previewActivated(handler, g_variant_get_string(parameter, NULL));
+            return;
+        }
+        break;
+    }
+    qWarning("Tried to activate gaction with incorrect parameter type.");
+}
 
-    } else if (g_variant_is_of_type(parameter, G_VARIANT_TYPE_DOUBLE)) {
-        Q_ASSERT(action->parameterType() == Action::Real);
-        float arg = g_variant_get_double(parameter);
-        action->trigger(QVariant(arg));
+void
+ActionManager::Private::previewActivated(ActivationHandler *handler, const gchar *state)
+{
+    PreviewAction *previewAction = handler->previewAction;
+    Q_ASSERT(previewAction != 0);
 
-    } else {
-        qWarning("Tried to activate gaction with incorrect parameter type.");
+    PreviewState previewStateValue = previewState(state);
+    if (previewStateValue == UnknownState) {
+        qWarning("Unknown PreviewAction state: %s", state);
+        return;
+    }
+    if (previewStateValue != StartState) {
+        // the preview must see the final values of the parameters
+        foreach (const QPointer<PreviewRangeParameter> &range, handler->ranges) {
+            if (!range.isNull())
+                range->flushPendingValue();
+        }
+    }
+    switch (previewStateValue) {
+    case StartState:
+        emit previewAction->started();
+        break;
+    case EndState:
+        // just skip for now
+        break;
+    case CommitState:
+        emit previewAction->trigger();
+        break;
+    case ResetState:
+        emit previewAction->resetted();
+        break;
+    case CancelState:
+        emit previewAction->cancelled();
+        break;
+    case UnknownState:
+        break;
     }
 }
 
@@ -955,24 +2292,16 @@ ActionManager::Private::createAction(Action *action)
     createActionData(action, adata);
     actionData.insert(action, adata);
 
-    connect(action, SIGNAL(nameChanged(QString)), this, SLOT(actionNameChanged()));
-    connect(action, SIGNAL(parameterTypeChanged(unity::action::Action::Type)), this, SLOT(actionParameterTypeChanged()));
-    connect(action, SIGNAL(enabledChanged(bool)), this, SLOT(actionEnabledChanged()));
-    connect(action, SIGNAL(textChanged(QString)), this, SLOT(actionPropertiesChanged()));
-    // don't care about iconName
-    connect(action, SIGNAL(descriptionChanged(QString)), this, SLOT(actionPropertiesChanged()));
-    connect(action, SIGNAL(keywordsChanged(QString)), this, SLOT(actionPropertiesChanged()));
-    connect(action, SIGNAL(enabledChanged(bool)), this, SLOT(actionPropertiesChanged()));
-
-    if (adata.isPreviewAction) {
-        PreviewAction *previewAction = qobject_cast<PreviewAction *>(action);
-        Q_ASSERT(previewAction != 0);
-        connect(previewAction, SIGNAL(commitLabelChanged(QString)), this, SLOT(previewActionCommitLabelChanged()));
-        connect(previewAction, SIGNAL(parametersChanged()), this, SLOT(previewActionParametersChanged()));
-    }
+    // one connection covers all the properties, see actionChanged()
+    connect(action, SIGNAL(propertiesChanged(unity::action::Action::ChangeMask)),
+            this, SLOT(actionChanged(unity::action::Action::ChangeMask)));
+    connect(action, SIGNAL(destroyed(QObject*)), this, SLOT(actionDestroyed(QObject*)));
 
     actions.insert(action);
-    emit q->actionsChanged();
+    generation++;
+    // re-added before the removal was signalled
+    if (!pendingRemovedActions.removeOne(action))
+        pendingAddedActions.append(action);
 }
 
 void
@@ -982,97 +2311,234 @@ ActionManager::Private::destroyAction(Action *action)
     const ActionData &adata = actionData[action];
 
     action->disconnect(this);
+    // the gaction might still be exported until the next update of the group
+    if (adata.gaction != 0)
+        g_signal_handlers_disconnect_by_data(G_OBJECT(adata.gaction), adata.handler.data());
+
+    dirtyActions.remove(action);
+    dirtyProperties.remove(action);
+    dirtyParameters.remove(action);
+
+    foreach (PreviewParameter *parameter, adata.params.keys()) {
+        parameterOwners.remove(parameter, action);
+    }
 
     actionData.remove(action);
     actions.remove(action);
+    generation++;
+    // removed before the addition was signalled
+    if (!pendingAddedActions.removeOne(action))
+        pendingRemovedActions.append(action);
+}
+
+/* Signals the actions created and destroyed since the last call at once,
+ * so that a bulk change or a batch emits each of the signals only once.
+ * While the updates are batched the signals wait for flushUpdates().
+ */
+void
+ActionManager::Private::emitActionChanges()
+{
+    if (updateDepth > 0)
+        return;
+    if (pendingAddedActions.isEmpty() && pendingRemovedActions.isEmpty())
+        return;
+
+    QList<Action *> added;
+    QList<Action *> removed;
+    added.swap(pendingAddedActions);
+    removed.swap(pendingRemovedActions);
+    if (!added.isEmpty())
+        emit q->actionsAdded(added);
+    if (!removed.isEmpty())
+        emit q->actionsRemoved(removed);
     emit q->actionsChanged();
 }
 
 void ActionManager::Private::createActionData(Action *action, ActionData &adata)
 {
-    const GVariantType *paramType = NULL;
+    /* The gaction and the desc depend on the name and the parameter type,
+     * which are often set only after the action has been added to a context.
+     * They are created when the action is first exported.
+     */
+    adata.handler = QSharedPointer<ActivationHandler>(new ActivationHandler);
+    adata.handler->action = action;
+    adata.handler->previewAction = 0;
+    adata.handler->kind = ActivationHandler::TriggerNone;
+    if (adata.isPreviewAction) {
+        checkPreviewParameterType(action);
+
+        PreviewAction *previewAction = qobject_cast<PreviewAction *>(action);
+        Q_ASSERT(previewAction != 0);
+        adata.handler->previewAction = previewAction;
+        adata.handler->kind = ActivationHandler::Preview;
+        adata.paramMenu = parameter_menu_new();
+        updatePreviewActionParameters(previewAction, adata);
+        updateParameterMenu(previewAction, adata);
+    }
+}
+
+void
+ActionManager::Private::checkPreviewParameterType(Action *action)
+{
+    if (action->parameterType() != Action::None) {
+        qWarning("%s:\n"
+                 "\tPreviewAction parameter type is not Action::None\n"
+                 "\tThis is not supported.\n"
+                 "\tSetting the parameter type to None",
+                 __PRETTY_FUNCTION__);
+        action->setParameterType(Action::None);
+    }
+}
+
+static const GVariantType *
+gactionParameterType(Action *action, const ActionData &adata)
+{
+    if (adata.isPreviewAction) {
+        // PreviewActions have to have string paramType as an implementation detail.
+        return G_VARIANT_TYPE_STRING;
+    }
+
     switch(action->parameterType()) {
     case Action::None:
-        paramType = NULL;
-        break;
+        return NULL;
     case Action::String:
-        paramType = G_VARIANT_TYPE_STRING;
-        break;
+        return G_VARIANT_TYPE_STRING;
     case Action::Integer:
-        paramType = G_VARIANT_TYPE_INT32;
-        break;
+        return G_VARIANT_TYPE_INT32;
     case Action::Bool:
-        paramType = G_VARIANT_TYPE_BOOLEAN;
-        break;
+        return G_VARIANT_TYPE_BOOLEAN;
     case Action::Real:
-        paramType = G_VARIANT_TYPE_DOUBLE;
-        break;
+        return G_VARIANT_TYPE_DOUBLE;
     }
+    return NULL;
+}
 
-    if (adata.isPreviewAction) {
-        if (action->parameterType() != Action::None) {
-            qWarning("%s:\n"
-                     "\tPreviewAction parameter type is not Action::None\n"
-                     "\tThis is not supported.\n"
-                     "\tSetting the parameter type to None",
-                     __PRETTY_FUNCTION__);
-            action->setParameterType(Action::None);
+GSimpleAction *
+ActionManager::Private::createGAction(Action *action, const ActionData &adata)
+{
+    GSimpleAction *gaction;
+    gaction = g_simple_action_new(qPrintable(action->name()),
+                                  gactionParameterType(action, adata));
+    g_simple_action_set_enabled(gaction, action->enabled());
+
+    // the gaction is replaced when the parameter type changes
+    ActivationHandler *handler = adata.handler.data();
+    Q_ASSERT(handler != 0);
+    if (!adata.isPreviewAction) {
+        switch (action->parameterType()) {
+        case Action::None:
+            handler->kind = ActivationHandler::TriggerNone;
+            break;
+        case Action::String:
+            handler->kind = ActivationHandler::TriggerString;
+            break;
+        case Action::Integer:
+            handler->kind = ActivationHandler::TriggerInt;
+            break;
+        case Action::Bool:
+            handler->kind = ActivationHandler::TriggerBool;
+            break;
+        case Action::Real:
+            handler->kind = ActivationHandler::TriggerReal;
+            break;
         }
-        // PreviewActions have to have string paramType as an implementation detail.
-        paramType = G_VARIANT_TYPE_STRING;
     }
-
-    QString actionid = action->name();
-    adata.gaction = g_simple_action_new(qPrintable(actionid),
-                                                   paramType);
-    g_simple_action_set_enabled(adata.gaction, action->enabled());
-    g_signal_connect(G_OBJECT(adata.gaction),
+    g_signal_connect(G_OBJECT(gaction),
                      "activate",
                      G_CALLBACK(Private::action_activated),
-                     action);
+                     handler);
+    return gaction;
+}
 
-    adata.desc = hud_action_description_new(qPrintable(QString("hud.%1").arg(actionid)), NULL);
-    updateActionDescription(action, adata.desc);
+HudActionDescription *
+ActionManager::Private::createDescription(Action *action, ActionData &adata)
+{
+    HudActionDescription *desc;
+    desc = hud_action_description_new(qPrintable(QString("hud.%1").arg(action->name())), NULL);
 
-    if (adata.isPreviewAction) {
-        PreviewAction *previewAction = qobject_cast<PreviewAction *>(action);
-        Q_ASSERT(previewAction != 0);
-        adata.paramMenu = g_menu_new();
-        updatePreviewActionParameters(previewAction, adata);
-        updateParameterMenu(previewAction, adata);
-        hud_action_description_set_parameterized(adata.desc, G_MENU_MODEL(adata.paramMenu));
+    // the cached attribute values belong to the previous desc
+    adata.cachedProperties = 0;
+    updateDescriptionAttributes(action, adata, desc, ActionData::AllProperties);
+
+    QuitAction *quitAction = qobject_cast<QuitAction *>(action);
+    if (quitAction != 0) {
+        hud_action_description_set_attribute_value(desc,
+                                                   "hud-toolbar-item",
+                                                   g_variant_new_string("quit"));
     }
+    if (adata.paramMenu != 0)
+        hud_action_description_set_parameterized(desc, G_MENU_MODEL(adata.paramMenu));
+    return desc;
 }
 
-void
-ActionManager::Private::updateActionDescription(Action *action,
-                                                HudActionDescription *desc)
+/* Sets a string attribute of the desc unless the cached value shows
+ * that the desc already has it. Each set makes the desc emit a change.
+ * Returns true if the attribute was set.
+ */
+static bool
+setDescriptionAttribute(HudActionDescription *desc,
+                        const char *attribute,
+                        const QString &value,
+                        QByteArray &cached,
+                        int property,
+                        int &cachedProperties)
+{
+    QByteArray encoded = value.toLocal8Bit();
+    if ((cachedProperties & property) && encoded == cached)
+        return false;
+    cached = encoded;
+    cachedProperties |= property;
+    hud_action_description_set_attribute_value(desc,
+                                               attribute,
+                                               g_variant_new_string(encoded.constData()));
+    return true;
+}
+
+int
+ActionManager::Private::updateDescriptionAttributes(Action *action,
+                                                    ActionData &adata,
+                                                    HudActionDescription *desc,
+                                                    int properties)
 {
     Q_ASSERT(action != 0);
     Q_ASSERT(desc   != 0);
 
-    hud_action_description_set_attribute_value(desc,
-                                               G_MENU_ATTRIBUTE_LABEL,
-                                               g_variant_new_string(qPrintable(action->text())));
-    hud_action_description_set_attribute_value(desc,
-                                               "description",
-                                               g_variant_new_string(qPrintable(action->description())));
-    hud_action_description_set_attribute_value(desc,
-                                               "keywords",
-                                               g_variant_new_string(qPrintable(action->keywords())));
+    int count = 0;
+    if (properties & ActionData::Text) {
+        count += setDescriptionAttribute(desc, G_MENU_ATTRIBUTE_LABEL, action->text(),
+                                         adata.text, ActionData::Text, adata.cachedProperties);
+    }
+    if (properties & ActionData::Description) {
+        count += setDescriptionAttribute(desc, "description", action->description(),
+                                         adata.description, ActionData::Description, adata.cachedProperties);
+    }
+    if (properties & ActionData::Keywords) {
+        count += setDescriptionAttribute(desc, "keywords", action->keywords(),
+                                         adata.keywords, ActionData::Keywords, adata.cachedProperties);
+    }
 
     PreviewAction *previewAction = qobject_cast<PreviewAction *>(action);
-    if (previewAction != 0) {
-        hud_action_description_set_attribute_value(desc,
-                                                   "commitLabel",
-                                                   g_variant_new_string(qPrintable(previewAction->commitLabel())));
+    if (previewAction != 0 && (properties & ActionData::CommitLabel)) {
+        count += setDescriptionAttribute(desc, "commitLabel", previewAction->commitLabel(),
+                                         adata.commitLabel, ActionData::CommitLabel, adata.cachedProperties);
     }
+    return count;
+}
 
-    QuitAction *quitAction = qobject_cast<QuitAction *>(action);
-    if (quitAction != 0) {
-        hud_action_description_set_attribute_value(desc,
-                                                   "hud-toolbar-item",
-                                                   g_variant_new_string("quit"));
+void
+ActionManager::Private::updateActionProperties(Action *action,
+                                               ActionData &adata,
+                                               int properties)
+{
+    // the gaction and the desc pick up the current values when created
+    if (adata.gaction != 0 && (properties & ActionData::Enabled) &&
+        g_action_get_enabled(G_ACTION(adata.gaction)) != action->enabled()) {
+        g_simple_action_set_enabled(adata.gaction, action->enabled());
+        countTraffic(ActionManager::EnabledChange);
+    }
+    if (adata.desc != 0) {
+        int count = updateDescriptionAttributes(action, adata, adata.desc, properties);
+        countTraffic(ActionManager::AttributeSet, count);
     }
 }
 
@@ -1081,74 +2547,149 @@ ActionManager::Private::updateActionsWhenNameOrTypeHaveChanged(Action *action)
 {
     Q_ASSERT(actionData.contains(action));
     ActionData &adata = actionData[action];
-    ActionData tmpdata;
 
-    tmpdata.isPreviewAction = adata.isPreviewAction;
-    createActionData(action, tmpdata);
+    if (adata.isPreviewAction)
+        checkPreviewParameterType(action);
 
-    // update the gaction
-    g_signal_handlers_disconnect_by_data(G_OBJECT(adata.gaction), action);
-    g_clear_object(&adata.gaction);
-    adata.gaction = (GSimpleAction *)g_object_ref(tmpdata.gaction);
-    if (globalContext->allActions().contains(action) ||
-        (activeLocalContext != 0 && activeLocalContext->actions().contains(action))) {
-        updateActionGroup();
+    QByteArray name = action->name().toLocal8Bit();
+
+    /* The name and the parameter type of a gaction can not be changed,
+     * so replace it if either of them differs. The parameter gactions
+     * and the parameter menu are not affected and are kept as they are.
+     */
+    if (adata.gaction != 0) {
+        const GVariantType *type = gactionParameterType(action, adata);
+        const GVariantType *oldType = g_action_get_parameter_type(G_ACTION(adata.gaction));
+        bool typeChanged = (type == NULL || oldType == NULL) ?
+                    type != oldType : !g_variant_type_equal(type, oldType);
+        if (typeChanged || name != g_action_get_name(G_ACTION(adata.gaction)))
+            replaceGAction(action, createGAction(action, adata));
     }
 
-    // update the desc
-    // go through all the HUD contexts and add the new descriptor
-    foreach(ContextData cdata, contextData) {
-        if (cdata.actions.contains(action)) {
+    // the desc only depends on the name
+    if (adata.desc == 0 ||
+        "hud." + name == hud_action_description_get_action_name(adata.desc)) {
+        return;
+    }
 
-            // remove the old one
-            /* Removing descriptions is not supported in libhud at the moment.
-             * For now, let's just empty the label and that will hide the
-             * action from the HUD.
-             */
-            hud_action_description_set_attribute_value(adata.desc,
-                                                       G_MENU_ATTRIBUTE_LABEL,
-                                                       g_variant_new_string(""));
+    HudActionDescription *desc = createDescription(action, adata);
 
-            hud_action_publisher_add_description(cdata.publisher,
-                                                 tmpdata.desc);
-        }
+    // remove the old one
+    /* Removing descriptions is not supported in libhud at the moment.
+     * For now, let's just empty the label and that will hide the
+     * action from the HUD.
+     */
+    hud_action_description_set_attribute_value(adata.desc,
+                                               G_MENU_ATTRIBUTE_LABEL,
+                                               g_variant_new_string(""));
+    countTraffic(ActionManager::AttributeSet);
+
+    // go through all the HUD contexts and add the new descriptor
+    QList<ActionContext *> affectedHudContexts;
+    foreach (ActionContext *context, hudContexts(action)) {
+        ContextData &cdata = contextData[context];
+        if (cdata.publisher == 0 || !cdata.hudActions.contains(action))
+            continue;
+        hud_action_publisher_add_description(cdata.publisher, desc);
+        countTraffic(ActionManager::DescriptionAdd);
+        cdata.tombstones++;
+        affectedHudContexts.append(context);
+    }
+    g_object_unref(adata.desc);
+    adata.desc = desc;
+
+    foreach (ActionContext *context, affectedHudContexts) {
+        retireTombstones(context);
     }
-    g_clear_object(&adata.desc);
-    adata.desc = (HudActionDescription *)g_object_ref(tmpdata.desc);
 }
 
 void
-ActionManager::Private::actionNameChanged()
+ActionManager::Private::replaceGAction(Action *action, GSimpleAction *gaction)
 {
-    Action *action= qobject_cast<Action *>(sender());
-    Q_ASSERT(action != 0);
-    updateActionsWhenNameOrTypeHaveChanged(action);
+    Q_ASSERT(actionData.contains(action));
+    ActionData &adata = actionData[action];
+    GSimpleAction *old = adata.gaction;
+    QByteArray oldName = g_action_get_name(G_ACTION(old));
+    QByteArray newName = g_action_get_name(G_ACTION(gaction));
+
+    g_signal_handlers_disconnect_by_data(G_OBJECT(old), adata.handler.data());
+    adata.gaction = gaction;
+
+    /* Patch the collected exports of the contexts in place instead of
+     * recollecting them. Only the two names can change in the group.
+     */
+    foreach (ActionContext *context, adata.contexts) {
+        ContextData &cdata = contextData[context];
+        if (cdata.staleExports.contains(action) || !cdata.actionExports.contains(action))
+            continue;
+        QHash<QByteArray, GSimpleAction *> &entries = cdata.actionExports[action];
+        entries.remove(oldName);
+        entries.insert(newName, gaction);
+        if (cdata.exports.value(oldName, 0) == old)
+            cdata.exports.remove(oldName);
+        cdata.exports.insert(newName, gaction);
+        if (exportsVisible(context)) {
+            dirtyExportNames.insert(oldName);
+            dirtyExportNames.insert(newName);
+        }
+    }
+    syncActionGroup();
+    g_object_unref(old);
 }
 
 void
-ActionManager::Private::actionParameterTypeChanged()
+ActionManager::Private::actionChanged(Action::ChangeMask changes)
 {
-    Action *action= qobject_cast<Action *>(sender());
+    Action *action = qobject_cast<Action *>(sender());
     Q_ASSERT(action != 0);
-    updateActionsWhenNameOrTypeHaveChanged(action);
+
+    if (changes & (Action::NameChange | Action::ParameterTypeChange))
+        actionNameOrTypeChanged(action);
+
+    // don't care about iconName
+    int properties = 0;
+    if (changes & Action::EnabledChange)
+        properties |= ActionData::Enabled;
+    if (changes & Action::TextChange)
+        properties |= ActionData::Text;
+    if (changes & Action::DescriptionChange)
+        properties |= ActionData::Description;
+    if (changes & Action::KeywordsChange)
+        properties |= ActionData::Keywords;
+    if (changes & Action::CommitLabelChange)
+        properties |= ActionData::CommitLabel;
+    if (properties != 0)
+        actionPropertiesChanged(action, properties);
+
+    if (changes & Action::ParametersChange) {
+        PreviewAction *previewAction = qobject_cast<PreviewAction *>(action);
+        Q_ASSERT(previewAction != 0);
+        previewActionParametersChanged(previewAction);
+    }
 }
 
 void
-ActionManager::Private::actionEnabledChanged()
+ActionManager::Private::actionNameOrTypeChanged(Action *action)
 {
-    Action *action= qobject_cast<Action *>(sender());
-    Q_ASSERT(action != 0);
-    Q_ASSERT(actionData.contains(action));
-    g_simple_action_set_enabled(actionData[action].gaction, action->enabled());
+    OperationScope scope(this, ActionManager::PropertyOperation);
+    if (deferUpdate()) {
+        dirtyActions.insert(action);
+        return;
+    }
+    updateActionsWhenNameOrTypeHaveChanged(action);
 }
 
 void
-ActionManager::Private::actionPropertiesChanged()
+ActionManager::Private::actionPropertiesChanged(Action *action, int properties)
 {
-    Action *action= qobject_cast<Action *>(sender());
+    OperationScope scope(this, ActionManager::PropertyOperation);
     Q_ASSERT(action != 0);
     Q_ASSERT(actionData.contains(action));
-    updateActionDescription(action, actionData[action].desc);
+    if (deferUpdate()) {
+        dirtyProperties[action] |= properties;
+        return;
+    }
+    updateActionProperties(action, actionData[action], properties);
 }
 
 /************************************************************************/
@@ -1156,31 +2697,27 @@ ActionManager::Private::actionPropertiesChanged()
 /************************************************************************/
 
 void
-ActionManager::Private::previewActionParametersChanged()
+ActionManager::Private::previewActionParametersChanged(PreviewAction *action)
 {
-    PreviewAction *action = qobject_cast<PreviewAction *>(sender());
-    Q_ASSERT(action != 0);
+    OperationScope scope(this, ActionManager::ParameterOperation);
     Q_ASSERT(actionData.contains(action));
     ActionData &adata = actionData[action];
 
+    if (deferUpdate()) {
+        dirtyParameters.insert(action);
+        return;
+    }
+
     updatePreviewActionParameters(action, adata);
     updateParameterMenu(action, adata);
+    invalidateExports(action);
 
-    if (globalContext->actions().contains(action) ||
-        (activeLocalContext != 0 && activeLocalContext->actions().contains(action))) {
-        updateActionGroup();
+    if (globalContext->containsAction(action) ||
+        (activeLocalContext != 0 && activeLocalContext->contains(action))) {
+        syncActionGroup();
     }
 }
 
-void
-ActionManager::Private::previewActionCommitLabelChanged()
-{
-    Action *action= qobject_cast<Action *>(sender());
-    Q_ASSERT(action != 0);
-    Q_ASSERT(actionData.contains(action));
-    updateActionDescription(action, actionData[action].desc);
-}
-
 void
 ActionManager::Private::updatePreviewActionParameters(PreviewAction *action,
                                                       ActionData &adata)
@@ -1215,7 +2752,10 @@ ActionManager::Private::updatePreviewActionParameters(PreviewAction *action,
             g_signal_handlers_disconnect_by_data(G_OBJECT(pdata.gaction),
                                                  range);
 
-            range->disconnect(this);
+            parameterOwners.remove(range, action);
+            // the parameter might still be part of other preview actions
+            if (!parameterOwners.contains(range))
+                range->disconnect(this);
 
             adata.params.remove(range);
         } else {
@@ -1242,17 +2782,26 @@ ActionManager::Private::updatePreviewActionParameters(PreviewAction *action,
                                             "parameter-type",
                                             g_variant_new_string("slider"));
 
-            pdata.gaction = g_simple_action_new(qPrintable(actionid), G_VARIANT_TYPE_DOUBLE);
+            pdata.gaction = g_simple_action_new_stateful(qPrintable(actionid),
+                                                         G_VARIANT_TYPE_DOUBLE,
+                                                         g_variant_new_double(range->value()));
             g_signal_connect(G_OBJECT(pdata.gaction),
                              "activate",
                              G_CALLBACK(Private::range_action_activated),
                              range);
+            g_signal_connect(G_OBJECT(pdata.gaction),
+                             "change-state",
+                             G_CALLBACK(Private::range_action_change_state),
+                             range);
 
             pdata.parameter = range;
-            connect(range, SIGNAL(valueChanged(float)), this, SLOT(previewRangeParameterValueChanged()));
-            connect(range, SIGNAL(textChanged(QString)), this, SLOT(previewRangeParameterPropertiesChanged()));
-            connect(range, SIGNAL(minimumValueChanged(float)), this, SLOT(previewRangeParameterPropertiesChanged()));
-            connect(range, SIGNAL(maximumValueChanged(float)), this, SLOT(previewRangeParameterPropertiesChanged()));
+            if (!parameterOwners.contains(range)) {
+                connect(range, SIGNAL(valueChanged(float)), this, SLOT(previewRangeParameterValueChanged()));
+                connect(range, SIGNAL(textChanged(QString)), this, SLOT(previewRangeParameterPropertiesChanged()));
+                connect(range, SIGNAL(minimumValueChanged(float)), this, SLOT(previewRangeParameterPropertiesChanged()));
+                connect(range, SIGNAL(maximumValueChanged(float)), this, SLOT(previewRangeParameterPropertiesChanged()));
+            }
+            parameterOwners.insert(range, action);
 
             adata.params.insert(range, pdata);
             updateRange(range, adata);
@@ -1263,28 +2812,80 @@ ActionManager::Private::updatePreviewActionParameters(PreviewAction *action,
                      parameter->metaObject()->className());
         }
     }
+
+    // the ranges flushed by previewActivated(), in the order of the parameters
+    Q_ASSERT(!adata.handler.isNull());
+    adata.handler->ranges.clear();
+    foreach (PreviewParameter *parameter, currentParameters) {
+        PreviewRangeParameter *range = qobject_cast<PreviewRangeParameter *>(parameter);
+        if (range != 0 && adata.params.contains(range))
+            adata.handler->ranges.append(range);
+    }
+}
+
+// returns the GMenuModel of the parameters of a preview action or 0
+void *
+ActionManager::Private::parameterMenu(QObject *action) const
+{
+    QHash<Action *, ActionData>::const_iterator i = actionData.constFind((Action *)action);
+    if (i == actionData.constEnd())
+        return 0;
+    return i.value().paramMenu;
 }
 
 void
-ActionManager::Private::updateParameterMenu(PreviewAction *action, const ActionData &adata)
+ActionManager::Private::updateParameterMenu(PreviewAction *action, ActionData &adata)
 {
     Q_ASSERT(adata.paramMenu != 0);
-    /* as g_menu and g_menu_model don't support indexing
-     * we just have to clear the whole menu and build a new one
+    const QList<PreviewParameter *> parameters = action->parameters();
+    const QList<PreviewParameter *> &current = adata.menuItems;
+    if (parameters == current)
+        return;
+
+    /* Keep the head and the tail the menu has in common with the new
+     * parameters and replace the items in between with one items-changed.
      */
-    // newest glib has g_menu_remove_all(), so we can use it in the future
-    while (g_menu_model_get_n_items(G_MENU_MODEL(adata.paramMenu)) > 0) {
-        g_menu_remove(adata.paramMenu, 0);
+    int head = 0;
+    while (head < current.count() && head < parameters.count()
+           && current[head] == parameters[head]) {
+        head++;
+    }
+    int tail = 0;
+    while (tail < current.count() - head && tail < parameters.count() - head
+           && current[current.count() - 1 - tail] == parameters[parameters.count() - 1 - tail]) {
+        tail++;
     }
 
-    foreach (PreviewParameter *parameter, action->parameters()) {
-        Q_ASSERT(adata.params.contains(parameter));
-        Q_ASSERT(adata.params[parameter].gmenuitem);
-        g_menu_append_item(adata.paramMenu,
-                           adata.params[parameter].gmenuitem);
+    int removed = current.count() - head - tail;
+    QList<GMenuItem *> added;
+    for (int i = head; i < parameters.count() - tail; i++) {
+        Q_ASSERT(adata.params.contains(parameters[i]));
+        Q_ASSERT(adata.params[parameters[i]].gmenuitem);
+        added.append(adata.params[parameters[i]].gmenuitem);
+    }
+    parameter_menu_splice(adata.paramMenu, head, removed, added);
+    adata.menuItems = parameters;
+
+    if (adata.desc != 0) {
+        hud_action_description_set_parameterized(adata.desc, G_MENU_MODEL(adata.paramMenu));
+        countTraffic(ActionManager::AttributeSet);
     }
-    hud_action_description_set_parameterized(adata.desc, G_MENU_MODEL(adata.paramMenu));
+}
 
+void
+ActionManager::Private::replaceParameterMenuItem(PreviewParameter *parameter,
+                                                 const ActionData &adata)
+{
+    /* The menu copies the attributes of an item when it's added, so the
+     * item of the changed parameter is swapped in with one items-changed.
+     * The rest of the menu and the description stay as they are.
+     */
+    int index = adata.menuItems.indexOf(parameter);
+    if (index < 0)
+        return;
+    Q_ASSERT(adata.params.contains(parameter));
+    parameter_menu_splice(adata.paramMenu, index, 1,
+                          QList<GMenuItem *>() << adata.params[parameter].gmenuitem);
 }
 
 
@@ -1304,48 +2905,74 @@ ActionManager::Private::range_action_activated(GSimpleAction *simpleaction,
     Q_ASSERT(that != 0);
 
     float value = g_variant_get_double(parameter);
-    that->setValue(value);
+    that->deliverValue(value);
+}
+
+
+void
+ActionManager::Private::range_action_change_state(GSimpleAction *simpleaction,
+                                                  GVariant      *value,
+                                                  gpointer       user_data)
+{
+    /* The state is not set here. It follows the value once the parameter
+     * accepted it, see previewRangeParameterValueChanged().
+     */
+    Q_UNUSED(simpleaction);
+    PreviewRangeParameter *that;
+    that = qobject_cast<PreviewRangeParameter *>((QObject*)user_data);
+    Q_ASSERT(that != 0);
+
+    that->deliverValue(g_variant_get_double(value));
 }
 
 
 void
 ActionManager::Private::previewRangeParameterValueChanged()
 {
-    /*! \bug preview parameters should use GAction::target to pass the values
-     *       instead of GAction::activated(). We can implement reset() only
-     *       by using target
-     *
-     *       This also requires changes to the HUD UI on the shell side.
-     *
-     *       The code below should be updated to actually change the state on each gaction.
-     *       if left uncommented we just generate additional range_action_activated() calls
-     *       without any benefit.
+    /* The value is published as the state of the range gactions, which
+     * lets the application move the slider in the HUD, e.g. on reset.
+     * The state is only touched when the value moved more than the
+     * epsilon of the parameter, so a value coming from the HUD is not
+     * echoed back to it.
      */
-#if 0
+    OperationScope scope(this, ActionManager::ParameterOperation);
     PreviewRangeParameter *parameter = qobject_cast<PreviewRangeParameter *>(sender());
     Q_ASSERT(parameter != 0);
-    foreach (const ActionData &adata, actionData) {
-        foreach (const ParameterData &pdata, adata.params) {
-            if (pdata.parameter == parameter) {
-                g_action_activate(G_ACTION(pdata.gaction), g_variant_new_double(parameter->value()));
-            }
-        }
+    QMultiHash<PreviewParameter *, Action *>::const_iterator i;
+    for (i = parameterOwners.constFind(parameter);
+         i != parameterOwners.constEnd() && i.key() == parameter;
+         ++i) {
+        Q_ASSERT(actionData.contains(i.value()));
+        const ActionData &adata = actionData[i.value()];
+        Q_ASSERT(adata.params.contains(parameter));
+        GSimpleAction *gaction = adata.params[parameter].gaction;
+
+        GVariant *state = g_action_get_state(G_ACTION(gaction));
+        double current = g_variant_get_double(state);
+        g_variant_unref(state);
+        if (qAbs(current - (double)parameter->value()) <= parameter->valueEpsilon())
+            continue;
+
+        g_simple_action_set_state(gaction, g_variant_new_double(parameter->value()));
+        countTraffic(ActionManager::StateChange);
     }
-#endif
 }
 
 void
 ActionManager::Private::previewRangeParameterPropertiesChanged()
 {
+    OperationScope scope(this, ActionManager::ParameterOperation);
     PreviewRangeParameter *parameter = qobject_cast<PreviewRangeParameter *>(sender());
     Q_ASSERT(parameter != 0);
-    foreach (const ActionData &adata, actionData) {
-        if (adata.params.contains(parameter)) {
-            updateRange(parameter, adata);
-            PreviewAction *previewAction = qobject_cast<PreviewAction *>(actionData.key(adata));
-            Q_ASSERT(previewAction != 0);
-            updateParameterMenu(previewAction, adata);
-        }
+    QMultiHash<PreviewParameter *, Action *>::const_iterator i;
+    for (i = parameterOwners.constFind(parameter);
+         i != parameterOwners.constEnd() && i.key() == parameter;
+         ++i) {
+        Q_ASSERT(actionData.contains(i.value()));
+        const ActionData &adata = actionData[i.value()];
+        Q_ASSERT(adata.params.contains(parameter));
+        updateRange(parameter, adata);
+        replaceParameterMenuItem(parameter, adata);
     }
 }
 
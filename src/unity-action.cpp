@@ -16,8 +16,14 @@
 
 #include <unity/action/Action>
 #include <QMutex>
+#include <QAtomicPointer>
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QPointer>
 
 #include <QDebug>
+#include <QMetaMethod>
 
 using namespace unity::action;
 
@@ -79,9 +85,122 @@ namespace action {
  * Single precision floating point parameter.
  */
 
+/*!
+ * \enum Action::ActivationPolicy
+ * \brief How bursts of triggers are handled.
+ *
+ * Protects the application from a client or a stuck key triggering the
+ * action hundreds of times per second.
+ *
+ * \var Action::ActivationPolicy Action::Unrestricted
+ *
+ * Every trigger goes through right away.
+ *
+ * \var Action::ActivationPolicy Action::Debounce
+ *
+ * The action is triggered once the triggers stopped for activationInterval
+ * milliseconds, with the value of the last one.
+ *
+ * \var Action::ActivationPolicy Action::Throttle
+ *
+ * The action is triggered at most once every activationInterval
+ * milliseconds. The triggers in between are queued up to
+ * activationBacklog and overflowPolicy decides what to drop beyond that.
+ */
+
+/*!
+ * \enum Action::ChangeFlag
+ * \brief The properties reported by propertiesChanged().
+ *
+ * \var Action::ChangeFlag Action::NameChange
+ * \var Action::ChangeFlag Action::TextChange
+ * \var Action::ChangeFlag Action::IconNameChange
+ * \var Action::ChangeFlag Action::DescriptionChange
+ * \var Action::ChangeFlag Action::KeywordsChange
+ * \var Action::ChangeFlag Action::EnabledChange
+ * \var Action::ChangeFlag Action::ParameterTypeChange
+ *
+ * The property of the same name changed.
+ *
+ * \var Action::ChangeFlag Action::CommitLabelChange
+ *
+ * PreviewAction::commitLabel changed.
+ *
+ * \var Action::ChangeFlag Action::ParametersChange
+ *
+ * The parameters of a PreviewAction changed.
+ */
+
+/*!
+ * \enum Action::OverflowPolicy
+ * \brief What a throttled action drops when its backlog is full.
+ *
+ * \var Action::OverflowPolicy Action::DropNewest
+ *
+ * The new trigger is dropped.
+ *
+ * \var Action::OverflowPolicy Action::DropOldest
+ *
+ * The oldest queued trigger is dropped to make room for the new one.
+ */
+
 
 // property documentation
 
+/*!
+ * \property int Action::activationBacklog
+ * \since 1.1
+ *
+ * The number of triggers a throttled action queues. With 0 the triggers
+ * coming in too fast are dropped.
+ *
+ * \initvalue 0
+ *
+ * \accessors activationBacklog(), setActivationBacklog()
+ *
+ * \notify activationBacklogChanged()
+ */
+
+/*!
+ * \property int Action::activationInterval
+ * \since 1.1
+ *
+ * The quiet period in milliseconds of Action::Debounce and the minimum
+ * time between two triggers with Action::Throttle. Throttling to N
+ * triggers per second is an interval of 1000 / N.
+ *
+ * \initvalue 100
+ *
+ * \accessors activationInterval(), setActivationInterval()
+ *
+ * \notify activationIntervalChanged()
+ */
+
+/*!
+ * \property Action::ActivationPolicy Action::activationPolicy
+ * \since 1.1
+ *
+ * How bursts of triggers are handled. Changing the policy delivers the
+ * triggers held back by the previous one.
+ *
+ * \initvalue Action::Unrestricted
+ *
+ * \accessors activationPolicy(), setActivationPolicy()
+ *
+ * \notify activationPolicyChanged()
+ */
+
+/*!
+ * \property int Action::coalescedActivations
+ * \since 1.1
+ *
+ * The number of triggers merged into a later one by Action::Debounce.
+ *
+ * \accessors coalescedActivations(), resetActivationCounters()
+ *
+ * \notify activationCountersChanged()
+ */
+
 /*!
  * \property QString Action::description
  *
@@ -97,6 +216,17 @@ namespace action {
  * \notify descriptionChanged()
  */
 
+/*!
+ * \property int Action::droppedActivations
+ * \since 1.1
+ *
+ * The number of triggers dropped by Action::Throttle.
+ *
+ * \accessors droppedActivations(), resetActivationCounters()
+ *
+ * \notify activationCountersChanged()
+ */
+
 /*!
  * \property bool Action::enabled
  *
@@ -180,6 +310,19 @@ namespace action {
  * \notify nameChanged()
  */
 
+/*!
+ * \property Action::OverflowPolicy Action::overflowPolicy
+ * \since 1.1
+ *
+ * What a throttled action drops when activationBacklog is full.
+ *
+ * \initvalue Action::DropNewest
+ *
+ * \accessors overflowPolicy(), setOverflowPolicy()
+ *
+ * \notify overflowPolicyChanged()
+ */
+
 /*!
  * \property Action::Type Action::parameterType()
  *
@@ -210,6 +353,17 @@ namespace action {
 
 // signal documentation
 
+/*!
+ * \fn void Action::propertiesChanged(unity::action::Action::ChangeMask changes)
+ *
+ * Emitted after each of the individual change signals, with \a changes
+ * telling which property changed. PreviewAction reports its commitLabel
+ * and parameters through it as well.
+ *
+ * Lets an observer follow all the properties it cares about through a
+ * single connection.
+ */
+
 /*!
  * \fn void Action::triggered(QVariant)
  *
@@ -221,6 +375,41 @@ namespace action {
  * \code
  *     QString param = value.toString();
  * \endcode
+ *
+ * The typed signals below are emitted as well and don't box the value.
+ */
+
+/*!
+ * \fn void Action::triggeredNone()
+ *
+ * Emitted with triggered() when the parameterType is Action::None.
+ */
+
+/*!
+ * \fn void Action::triggeredString(const QString &value)
+ *
+ * Emitted with triggered() when the parameterType is Action::String.
+ */
+
+/*!
+ * \fn void Action::triggeredInt(int value)
+ *
+ * Emitted with triggered() when the parameterType is Action::Integer.
+ */
+
+/*!
+ * \fn void Action::triggeredBool(bool value)
+ *
+ * Emitted with triggered() when the parameterType is Action::Bool.
+ */
+
+/*!
+ * \fn void Action::triggeredReal(double value)
+ *
+ * Emitted with triggered() when the parameterType is Action::Real.
+ *
+ * Unlike triggered() the value keeps the double precision it was triggered
+ * with by triggerReal().
  */
 }
 }
@@ -238,6 +427,36 @@ public:
     bool enabled;
     Action::Type parameterType;
 
+    /* triggers posted from other threads, see postTrigger().
+     * A lock-free stack the producers push to and the owning thread
+     * takes as a whole.
+     */
+    struct PendingTrigger {
+        QVariant value;
+        PendingTrigger *next;
+    };
+    QAtomicPointer<PendingTrigger> pendingTriggers;
+    // set while a drain event is on its way to the owning thread
+    QAtomicInt drainPosted;
+
+    /* flood protection, see activationPolicy */
+    Action::ActivationPolicy activationPolicy;
+    Action::OverflowPolicy overflowPolicy;
+    int activationInterval;
+    int activationBacklog;
+    int droppedActivations;
+    int coalescedActivations;
+    // the triggers held back, a single one with Debounce
+    QList<QVariant> heldActivations;
+    int activationTimer;
+    // set while a held back trigger is delivered
+    bool delivering;
+
+    static QEvent::Type drainEventType() {
+        static const QEvent::Type type = (QEvent::Type)QEvent::registerEventType();
+        return type;
+    }
+
     const char *paramTypeName(Action::Type type) {
         switch (type) {
         case Action::None:    return "None";
@@ -250,6 +469,19 @@ public:
         Q_ASSERT(0);
         return "Internal Error";
     }
+
+    // checks a typed trigger against the parameterType
+    bool canTrigger(Action::Type type, const char *function) {
+        if (!enabled)
+            return false;
+        if (parameterType == type)
+            return true;
+        qWarning() << function << ":\n"
+                   << "\tTrying to trigger action (name: " << name << " :: text: " << text << ")\n"
+                   << "\twhich has parameter type '" << paramTypeName(parameterType) << "'\n"
+                   << "\twith a value of type '" << paramTypeName(type) << "'";
+        return false;
+    }
 };
 
 /*!
@@ -264,9 +496,21 @@ Action::Action(QObject *parent)
       d(new Private())
 {
     qRegisterMetaType<unity::action::Action::Type>();
+    qRegisterMetaType<unity::action::Action::ActivationPolicy>();
+    qRegisterMetaType<unity::action::Action::OverflowPolicy>();
+    qRegisterMetaType<unity::action::Action::ChangeMask>();
     d->enabled = true;
     d->parameterType = None;
 
+    d->activationPolicy = Unrestricted;
+    d->overflowPolicy = DropNewest;
+    d->activationInterval = 100;
+    d->activationBacklog = 0;
+    d->droppedActivations = 0;
+    d->coalescedActivations = 0;
+    d->activationTimer = 0;
+    d->delivering = false;
+
     // autogenerate a unique name
     static QMutex mutex;
     QMutexLocker locker(&mutex);
@@ -277,6 +521,12 @@ Action::Action(QObject *parent)
 
 Action::~Action()
 {
+    Private::PendingTrigger *node = d->pendingTriggers.fetchAndStoreAcquire(0);
+    while (node != 0) {
+        Private::PendingTrigger *next = node->next;
+        delete node;
+        node = next;
+    }
 }
 
 QString
@@ -297,8 +547,10 @@ Action::setName(const QString &value)
     else
         d->name = d->generatedname;
 
-    if (oldName != d->name)
+    if (oldName != d->name) {
         emit nameChanged(d->name);
+        emit propertiesChanged(NameChange);
+    }
 }
 
 QString
@@ -314,6 +566,7 @@ Action::setText(const QString &value)
         return;
     d->text = value;
     emit textChanged(value);
+    emit propertiesChanged(TextChange);
 }
 
 QString
@@ -329,6 +582,7 @@ Action::setIconName(const QString &value)
         return;
     d->iconName = value;
     emit iconNameChanged(value);
+    emit propertiesChanged(IconNameChange);
 }
 
 QString
@@ -344,6 +598,7 @@ Action::setDescription(const QString &value)
         return;
     d->description = value;
     emit descriptionChanged(value);
+    emit propertiesChanged(DescriptionChange);
 }
 
 QString
@@ -359,6 +614,7 @@ Action::setKeywords(const QString &value)
         return;
     d->keywords = value;
     emit keywordsChanged(value);
+    emit propertiesChanged(KeywordsChange);
 }
 
 bool
@@ -374,6 +630,7 @@ Action::setEnabled(bool value)
         return;
     d->enabled = value;
     emit enabledChanged(value);
+    emit propertiesChanged(EnabledChange);
 }
 
 Action::Type
@@ -389,6 +646,165 @@ Action::setParameterType(Type value)
         return;
     d->parameterType = value;
     emit parameterTypeChanged(value);
+    emit propertiesChanged(ParameterTypeChange);
+}
+
+Action::ActivationPolicy
+Action::activationPolicy() const
+{
+    return d->activationPolicy;
+}
+
+void
+Action::setActivationPolicy(ActivationPolicy value)
+{
+    if (d->activationPolicy == value)
+        return;
+    flushActivations();
+    d->activationPolicy = value;
+    emit activationPolicyChanged(value);
+}
+
+int
+Action::activationInterval() const
+{
+    return d->activationInterval;
+}
+
+void
+Action::setActivationInterval(int value)
+{
+    if (value < 0) {
+        qWarning("%s: trying to set a negative interval (%d)",
+                 __PRETTY_FUNCTION__,
+                 value);
+        value = 0;
+    }
+    if (d->activationInterval == value)
+        return;
+    d->activationInterval = value;
+    emit activationIntervalChanged(value);
+}
+
+int
+Action::activationBacklog() const
+{
+    return d->activationBacklog;
+}
+
+void
+Action::setActivationBacklog(int value)
+{
+    if (value < 0) {
+        qWarning("%s: trying to set a negative backlog (%d)",
+                 __PRETTY_FUNCTION__,
+                 value);
+        value = 0;
+    }
+    if (d->activationBacklog == value)
+        return;
+    d->activationBacklog = value;
+    emit activationBacklogChanged(value);
+}
+
+Action::OverflowPolicy
+Action::overflowPolicy() const
+{
+    return d->overflowPolicy;
+}
+
+void
+Action::setOverflowPolicy(OverflowPolicy value)
+{
+    if (d->overflowPolicy == value)
+        return;
+    d->overflowPolicy = value;
+    emit overflowPolicyChanged(value);
+}
+
+int
+Action::droppedActivations() const
+{
+    return d->droppedActivations;
+}
+
+int
+Action::coalescedActivations() const
+{
+    return d->coalescedActivations;
+}
+
+/*!
+ * Resets droppedActivations and coalescedActivations to 0.
+ */
+void
+Action::resetActivationCounters()
+{
+    if (d->droppedActivations == 0 && d->coalescedActivations == 0)
+        return;
+    d->droppedActivations = 0;
+    d->coalescedActivations = 0;
+    emit activationCountersChanged();
+}
+
+// returns true if a valid trigger may go through right away
+bool
+Action::admitActivation(const QVariant &value)
+{
+    if (d->activationPolicy == Unrestricted || d->delivering)
+        return true;
+
+    if (d->activationPolicy == Debounce) {
+        if (!d->heldActivations.isEmpty()) {
+            d->heldActivations.clear();
+            d->coalescedActivations++;
+            emit activationCountersChanged();
+        }
+        d->heldActivations.append(value);
+        if (d->activationTimer != 0)
+            killTimer(d->activationTimer);
+        d->activationTimer = startTimer(d->activationInterval);
+        return false;
+    }
+
+    // Throttle: the timer runs while the interval after a trigger lasts
+    if (d->activationTimer == 0) {
+        d->activationTimer = startTimer(d->activationInterval);
+        return true;
+    }
+    if (d->heldActivations.count() < d->activationBacklog) {
+        d->heldActivations.append(value);
+        return false;
+    }
+    if (d->overflowPolicy == DropOldest && !d->heldActivations.isEmpty()) {
+        d->heldActivations.removeFirst();
+        d->heldActivations.append(value);
+    }
+    d->droppedActivations++;
+    emit activationCountersChanged();
+    return false;
+}
+
+// delivers the triggers held back right away
+void
+Action::flushActivations()
+{
+    if (d->activationTimer != 0) {
+        killTimer(d->activationTimer);
+        d->activationTimer = 0;
+    }
+    QList<QVariant> held = d->heldActivations;
+    d->heldActivations.clear();
+
+    QPointer<Action> guard(this);
+    foreach (const QVariant &value, held) {
+        if (guard.isNull())
+            return;
+        d->delivering = true;
+        trigger(value);
+        if (!guard.isNull())
+            d->delivering = false;
+    }
 }
 
 /*!
@@ -433,6 +849,15 @@ Action::trigger(QVariant value)
     }
     }
 
+    // the manager decodes the values into the right type already
+    if (targetType != QMetaType::UnknownType && value.userType() == targetType) {
+        if (!admitActivation(value))
+            return;
+        emitTyped(value);
+        emit triggered(value);
+        return;
+    }
+
     // need to take a copy of the value as we have to try to convert() it.
     QVariant tmp = value;
     if ((targetType == QMetaType::UnknownType && d->parameterType != None) ||
@@ -444,5 +869,202 @@ Action::trigger(QVariant value)
         return;
     }
 
+    if (!admitActivation(value))
+        return;
+    // a converted Real would be narrowed to float, the original keeps the precision
+    emitTyped(d->parameterType == Real ? value : tmp);
     emit triggered(value);
 }
+
+// emits the typed signal for a value already converted to the parameterType
+void
+Action::emitTyped(const QVariant &value)
+{
+    switch (d->parameterType) {
+    case None:
+        emit triggeredNone();
+        break;
+    case String:
+        emit triggeredString(value.toString());
+        break;
+    case Integer:
+        emit triggeredInt(value.toInt());
+        break;
+    case Bool:
+        emit triggeredBool(value.toBool());
+        break;
+    case Real:
+        emit triggeredReal(value.toDouble());
+        break;
+    }
+}
+
+/*!
+ * Triggers an action with a parameterType of Action::None.
+ *
+ * Emits triggeredNone() and, only if something is connected to it,
+ * triggered(). Unlike trigger() no QVariant is checked or converted.
+ */
+void
+Action::triggerNone()
+{
+    if (!d->canTrigger(None, __PRETTY_FUNCTION__))
+        return;
+    if (d->activationPolicy != Unrestricted && !admitActivation(QVariant()))
+        return;
+    emit triggeredNone();
+    static const QMetaMethod signal = QMetaMethod::fromSignal(&Action::triggered);
+    if (isSignalConnected(signal))
+        emit triggered(QVariant());
+}
+
+/*!
+ * Triggers an action with a parameterType of Action::String.
+ *
+ * Emits triggeredString() and, only if something is connected to it,
+ * triggered(). Unlike trigger() the value is not boxed in a QVariant
+ * for the type check.
+ */
+void
+Action::triggerString(const QString &value)
+{
+    if (!d->canTrigger(String, __PRETTY_FUNCTION__))
+        return;
+    if (d->activationPolicy != Unrestricted && !admitActivation(QVariant(value)))
+        return;
+    emit triggeredString(value);
+    static const QMetaMethod signal = QMetaMethod::fromSignal(&Action::triggered);
+    if (isSignalConnected(signal))
+        emit triggered(QVariant(value));
+}
+
+/*!
+ * Triggers an action with a parameterType of Action::Integer.
+ *
+ * \sa triggerString()
+ */
+void
+Action::triggerInt(int value)
+{
+    if (!d->canTrigger(Integer, __PRETTY_FUNCTION__))
+        return;
+    if (d->activationPolicy != Unrestricted && !admitActivation(QVariant(value)))
+        return;
+    emit triggeredInt(value);
+    static const QMetaMethod signal = QMetaMethod::fromSignal(&Action::triggered);
+    if (isSignalConnected(signal))
+        emit triggered(QVariant(value));
+}
+
+/*!
+ * Triggers an action with a parameterType of Action::Bool.
+ *
+ * \sa triggerString()
+ */
+void
+Action::triggerBool(bool value)
+{
+    if (!d->canTrigger(Bool, __PRETTY_FUNCTION__))
+        return;
+    if (d->activationPolicy != Unrestricted && !admitActivation(QVariant(value)))
+        return;
+    emit triggeredBool(value);
+    static const QMetaMethod signal = QMetaMethod::fromSignal(&Action::triggered);
+    if (isSignalConnected(signal))
+        emit triggered(QVariant(value));
+}
+
+/*!
+ * Triggers an action with a parameterType of Action::Real.
+ *
+ * triggeredReal() gets the value with double precision. triggered()
+ * keeps passing a float for compatibility.
+ *
+ * \sa triggerString()
+ */
+void
+Action::triggerReal(double value)
+{
+    if (!d->canTrigger(Real, __PRETTY_FUNCTION__))
+        return;
+    if (d->activationPolicy != Unrestricted && !admitActivation(QVariant(value)))
+        return;
+    emit triggeredReal(value);
+    static const QMetaMethod signal = QMetaMethod::fromSignal(&Action::triggered);
+    if (isSignalConnected(signal))
+        emit triggered(QVariant((float)value));
+}
+
+/*!
+ * Triggers the action from any thread.
+ *
+ * The value is queued without taking a lock and trigger() is called with
+ * it on the thread the action lives in. The triggers posted until the
+ * owning thread gets to them are handled in one batch, in the order they
+ * were posted, with a single event instead of one queued call each.
+ *
+ * The action must outlive the calls to postTrigger() made for it.
+ */
+void
+Action::postTrigger(const QVariant &value)
+{
+    Private::PendingTrigger *node = new Private::PendingTrigger;
+    node->value = value;
+    Private::PendingTrigger *top;
+    do {
+        top = d->pendingTriggers.loadAcquire();
+        node->next = top;
+    } while (!d->pendingTriggers.testAndSetRelease(top, node));
+
+    // only the first trigger of a batch wakes up the owning thread
+    if (d->drainPosted.testAndSetOrdered(0, 1))
+        QCoreApplication::postEvent(this, new QEvent(Private::drainEventType()));
+}
+
+bool
+Action::event(QEvent *event)
+{
+    if (event->type() == QEvent::Timer
+        && static_cast<QTimerEvent *>(event)->timerId() == d->activationTimer) {
+        if (d->activationPolicy == Throttle && !d->heldActivations.isEmpty()) {
+            // one held back trigger per interval, the timer keeps running
+            QVariant value = d->heldActivations.takeFirst();
+            QPointer<Action> guard(this);
+            d->delivering = true;
+            trigger(value);
+            if (!guard.isNull())
+                d->delivering = false;
+        } else {
+            flushActivations();
+        }
+        return true;
+    }
+
+    if (event->type() != Private::drainEventType())
+        return QObject::event(event);
+
+    /* clear the flag before taking the batch so a trigger pushed after
+     * the take posts a new event
+     */
+    d->drainPosted.storeRelease(0);
+    Private::PendingTrigger *node = d->pendingTriggers.fetchAndStoreAcquire(0);
+
+    // the stack has the newest trigger on top
+    Private::PendingTrigger *ordered = 0;
+    while (node != 0) {
+        Private::PendingTrigger *next = node->next;
+        node->next = ordered;
+        ordered = node;
+        node = next;
+    }
+    // a slot might delete the action in the middle of the batch
+    QPointer<Action> guard(this);
+    while (ordered != 0) {
+        Private::PendingTrigger *next = ordered->next;
+        if (!guard.isNull())
+            trigger(ordered->value);
+        delete ordered;
+        ordered = next;
+    }
+    return true;
+}
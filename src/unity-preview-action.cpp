@@ -153,6 +153,7 @@ PreviewAction::setCommitLabel(const QString &value)
         return;
     d->commitLabel = value;
     emit commitLabelChanged(value);
+    emit propertiesChanged(CommitLabelChange);
 }
 
 /*!
@@ -188,6 +189,7 @@ PreviewAction::addParameter(unity::action::PreviewParameter *parameter)
     d->parameters.append(parameter);
     connect(parameter, SIGNAL(destroyed(QObject *)), d.data(), SLOT(parameterDestroyed(QObject *)));
     emit parametersChanged();
+    emit propertiesChanged(ParametersChange);
 }
 
 /*!
@@ -212,6 +214,7 @@ PreviewAction::removeParameter(unity::action::PreviewParameter *parameter)
     parameter->disconnect(d.data());
     d->parameters.removeOne(parameter);
     emit parametersChanged();
+    emit propertiesChanged(ParametersChange);
 }
 
 #include "unity-preview-action.moc"
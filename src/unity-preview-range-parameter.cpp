@@ -17,6 +17,9 @@
 #include <unity/action/PreviewRangeParameter>
 using namespace unity::action;
 
+#include <QTimer>
+#include <QElapsedTimer>
+
 namespace unity {
 namespace action {
 /*!
@@ -27,8 +30,79 @@ namespace action {
 }
 }
 
+/*!
+ * \enum PreviewRangeParameter::DeliveryPolicy
+ * \brief How the values coming from the HUD are delivered.
+ *
+ * A slider drag in the HUD can send many more values than the preview
+ * is able to render. The policy decides how many of them are passed on
+ * to setValue(). Values set by the application itself are always applied
+ * immediately.
+ *
+ * \var PreviewRangeParameter::DeliveryPolicy PreviewRangeParameter::Immediate
+ *
+ * Every value is delivered as soon as it arrives.
+ *
+ * \var PreviewRangeParameter::DeliveryPolicy PreviewRangeParameter::Coalesced
+ *
+ * The values are delivered on the next event loop iteration. Only the
+ * latest of the values received in between is delivered.
+ *
+ * \var PreviewRangeParameter::DeliveryPolicy PreviewRangeParameter::RateLimited
+ *
+ * At most maximumRate values are delivered per second. Only the latest of
+ * the values received in between is delivered.
+ */
+
 // properties
 
+/*!
+ * \property PreviewRangeParameter::DeliveryPolicy PreviewRangeParameter::deliveryPolicy
+ * \since 1.1
+ *
+ * How the values coming from the HUD are delivered to value().
+ *
+ * The pending value is always delivered before the PreviewAction is
+ * committed, cancelled, reset or ended, so the preview sees the exact
+ * final value.
+ *
+ * \initvalue PreviewRangeParameter::Immediate
+ *
+ * \accessors deliveryPolicy(), setDeliveryPolicy()
+ *
+ * \notify deliveryPolicyChanged()
+ */
+
+/*!
+ * \property float PreviewRangeParameter::valueEpsilon
+ * \since 1.1
+ *
+ * The smallest change of value that is sent back to the HUD.
+ *
+ * The value is published to the HUD as the state of the parameter. Changes
+ * of value() that are not bigger than this are not published.
+ *
+ * \initvalue 0.0f
+ *
+ * \accessors valueEpsilon(), setValueEpsilon()
+ *
+ * \notify valueEpsilonChanged()
+ */
+
+/*!
+ * \property int PreviewRangeParameter::maximumRate
+ * \since 1.1
+ *
+ * The maximum number of values delivered per second when deliveryPolicy is
+ * PreviewRangeParameter::RateLimited.
+ *
+ * \initvalue 60
+ *
+ * \accessors maximumRate(), setMaximumRate()
+ *
+ * \notify maximumRateChanged()
+ */
+
 /*!
  * \property float PreviewRangeParameter::maximumValue
  *
@@ -85,6 +159,16 @@ public:
     float value;
     float min;
     float max;
+
+    DeliveryPolicy policy;
+    int maximumRate;
+    float epsilon;
+
+    // the latest value from the HUD waiting to be delivered
+    bool hasPending;
+    float pending;
+    QTimer deliveryTimer;
+    QElapsedTimer lastDelivery;
 };
 
 /*!
@@ -101,6 +185,14 @@ PreviewRangeParameter::PreviewRangeParameter(QObject *parent)
     d->max = 100.0f;
     d->min = 0.0f;
     d->value = 0.0f;
+
+    d->policy = Immediate;
+    d->maximumRate = 60;
+    d->epsilon = 0.0f;
+    d->hasPending = false;
+    d->pending = 0.0f;
+    d->deliveryTimer.setSingleShot(true);
+    connect(&d->deliveryTimer, SIGNAL(timeout()), this, SLOT(flushPendingValue()));
 }
 
 PreviewRangeParameter::~PreviewRangeParameter()
@@ -131,6 +223,10 @@ PreviewRangeParameter::value() const
 void
 PreviewRangeParameter::setValue(float value)
 {
+    // the value set last wins over the one still waiting for delivery
+    d->hasPending = false;
+    d->deliveryTimer.stop();
+
     if (qFuzzyCompare(d->value, value))
         return;
 
@@ -215,3 +311,121 @@ PreviewRangeParameter::setMaximumValue(float value)
         setValue(d->max);
     }
 }
+
+PreviewRangeParameter::DeliveryPolicy
+PreviewRangeParameter::deliveryPolicy() const
+{
+    return d->policy;
+}
+
+void
+PreviewRangeParameter::setDeliveryPolicy(DeliveryPolicy value)
+{
+    if (d->policy == value)
+        return;
+    d->policy = value;
+    // don't leave a value behind the new policy would never deliver
+    flushPendingValue();
+    emit deliveryPolicyChanged(value);
+}
+
+int
+PreviewRangeParameter::maximumRate() const
+{
+    return d->maximumRate;
+}
+
+void
+PreviewRangeParameter::setMaximumRate(int value)
+{
+    if (value < 1) {
+        qWarning("%s: trying to set maximum rate (%d) below 1",
+                 __PRETTY_FUNCTION__,
+                 value);
+        value = 1;
+    }
+    if (d->maximumRate == value)
+        return;
+    d->maximumRate = value;
+    emit maximumRateChanged(value);
+}
+
+float
+PreviewRangeParameter::valueEpsilon() const
+{
+    return d->epsilon;
+}
+
+void
+PreviewRangeParameter::setValueEpsilon(float value)
+{
+    if (value < 0.0f) {
+        qWarning("%s: trying to set a negative epsilon (%f)",
+                 __PRETTY_FUNCTION__,
+                 value);
+        value = 0.0f;
+    }
+    if (d->epsilon == value)
+        return;
+    d->epsilon = value;
+    emit valueEpsilonChanged(value);
+}
+
+/*!
+ * Passes a \a value received from the HUD on to setValue() as
+ * deliveryPolicy says.
+ *
+ * \sa flushPendingValue()
+ */
+void
+PreviewRangeParameter::deliverValue(float value)
+{
+    if (d->policy == Immediate) {
+        setValue(value);
+        return;
+    }
+
+    d->pending = value;
+    d->hasPending = true;
+    if (d->deliveryTimer.isActive())
+        return;
+
+    if (d->policy == Coalesced) {
+        d->deliveryTimer.start(0);
+        return;
+    }
+
+    qint64 interval = 1000 / d->maximumRate;
+    qint64 elapsed = d->lastDelivery.isValid() ? d->lastDelivery.elapsed() : interval;
+    if (elapsed >= interval) {
+        flushPendingValue();
+    } else {
+        d->deliveryTimer.start(interval - elapsed);
+    }
+}
+
+/*!
+ * \returns true if a value passed to deliverValue() is still waiting to be
+ *          delivered.
+ */
+bool
+PreviewRangeParameter::hasPendingValue() const
+{
+    return d->hasPending;
+}
+
+/*!
+ * Delivers the value waiting in deliverValue() right away.
+ *
+ * Does nothing if there is no pending value.
+ */
+void
+PreviewRangeParameter::flushPendingValue()
+{
+    d->deliveryTimer.stop();
+    if (!d->hasPending)
+        return;
+    d->hasPending = false;
+    d->lastDelivery.start();
+    setValue(d->pending);
+}
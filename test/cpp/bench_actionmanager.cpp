@@ -0,0 +1,348 @@
+/* This file is part of unity-action-api
+ * Copyright 2013 Canonical Ltd.
+ *
+ * unity-action-api is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * unity-action-api is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_actionmanager.h"
+
+#include <unity/action/ActionManager>
+#include <unity/action/ActionContext>
+#include <unity/action/Action>
+
+#include <unity/action/PreviewAction>
+#include <unity/action/PreviewRangeParameter>
+
+#include <QtTest/QtTest>
+
+// needed for gio includes.
+#undef signals
+#include <gio/gio.h>
+
+using namespace unity::action;
+
+static QList<Action *>
+createActions(int count, QObject *parent, const QString &prefix)
+{
+    QList<Action *> actions;
+    for (int i = 0; i < count; i++) {
+        Action *action = new Action(parent);
+        action->setName(QString("%1%2").arg(prefix).arg(i));
+        action->setText(QString("Action %1").arg(i));
+        actions.append(action);
+    }
+    return actions;
+}
+
+static QList<PreviewAction *>
+createPreviewActions(int count, int parameters, QObject *parent)
+{
+    QList<PreviewAction *> actions;
+    for (int i = 0; i < count; i++) {
+        PreviewAction *action = new PreviewAction(parent);
+        action->setName(QString("Preview%1").arg(i));
+        for (int j = 0; j < parameters; j++) {
+            action->addParameter(new PreviewRangeParameter(action));
+        }
+        actions.append(action);
+    }
+    return actions;
+}
+
+void
+BenchActionManager::initTestCase()
+{
+    manager = new ActionManager(this);
+
+    dbusc = g_bus_get_sync(G_BUS_TYPE_SESSION, NULL, NULL);
+    QVERIFY2(dbusc != 0, "Could not get session bus.");
+    action_group = g_dbus_action_group_get(dbusc,
+                                           g_dbus_connection_get_unique_name(dbusc),
+                                           "/com/canonical/unity/actions");
+    QVERIFY2(action_group != 0, "Could not get action group");
+}
+
+void
+BenchActionManager::cleanupTestCase()
+{
+    g_clear_object(&action_group);
+    g_clear_object(&dbusc);
+}
+
+void
+BenchActionManager::addActions_data()
+{
+    QTest::addColumn<int>("actions");
+
+    QTest::newRow("10")    << 10;
+    QTest::newRow("100")   << 100;
+    QTest::newRow("1000")  << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+void
+BenchActionManager::addActions()
+{
+    QFETCH(int, actions);
+
+    QObject parent;
+    QList<Action *> list = createActions(actions, &parent, "Global");
+
+    QBENCHMARK {
+        foreach (Action *action, list) {
+            manager->addAction(action);
+        }
+        foreach (Action *action, list) {
+            manager->removeAction(action);
+        }
+    }
+    QCOMPARE(manager->actions().count(), 1);
+}
+
+void
+BenchActionManager::addLocalContexts_data()
+{
+    QTest::addColumn<int>("contexts");
+    QTest::addColumn<int>("actions");
+
+    QTest::newRow("1x10")    << 1   << 10;
+    QTest::newRow("10x10")   << 10  << 10;
+    QTest::newRow("100x10")  << 100 << 10;
+    QTest::newRow("500x10")  << 500 << 10;
+    QTest::newRow("100x100") << 100 << 100;
+}
+
+void
+BenchActionManager::addLocalContexts()
+{
+    QFETCH(int, contexts);
+    QFETCH(int, actions);
+
+    QObject parent;
+    QList<ActionContext *> list;
+    for (int i = 0; i < contexts; i++) {
+        ActionContext *context = new ActionContext(&parent);
+        foreach (Action *action, createActions(actions, context, QString("Local%1_").arg(i))) {
+            context->addAction(action);
+        }
+        list.append(context);
+    }
+
+    QBENCHMARK {
+        foreach (ActionContext *context, list) {
+            manager->addLocalContext(context);
+        }
+        foreach (ActionContext *context, list) {
+            manager->removeLocalContext(context);
+        }
+    }
+    QCOMPARE(manager->localContexts().count(), 0);
+}
+
+void
+BenchActionManager::switchLocalContext_data()
+{
+    QTest::addColumn<int>("contexts");
+    QTest::addColumn<int>("actions");
+
+    QTest::newRow("2x10")    << 2   << 10;
+    QTest::newRow("10x100")  << 10  << 100;
+    QTest::newRow("100x10")  << 100 << 10;
+    QTest::newRow("500x10")  << 500 << 10;
+}
+
+void
+BenchActionManager::switchLocalContext()
+{
+    QFETCH(int, contexts);
+    QFETCH(int, actions);
+
+    QObject parent;
+    QList<ActionContext *> list;
+    for (int i = 0; i < contexts; i++) {
+        ActionContext *context = new ActionContext(&parent);
+        // the same names in every context so that they shadow each other
+        foreach (Action *action, createActions(actions, context, "Local")) {
+            context->addAction(action);
+        }
+        manager->addLocalContext(context);
+        list.append(context);
+    }
+
+    QBENCHMARK {
+        foreach (ActionContext *context, list) {
+            context->setActive(true);
+        }
+    }
+
+    foreach (ActionContext *context, list) {
+        manager->removeLocalContext(context);
+    }
+}
+
+void
+BenchActionManager::renameAction_data()
+{
+    QTest::addColumn<int>("actions");
+
+    QTest::newRow("10")    << 10;
+    QTest::newRow("100")   << 100;
+    QTest::newRow("1000")  << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+void
+BenchActionManager::renameAction()
+{
+    QFETCH(int, actions);
+
+    QObject parent;
+    QList<Action *> list = createActions(actions, &parent, "Rename");
+    foreach (Action *action, list) {
+        manager->addAction(action);
+    }
+
+    Action *action = list.first();
+    int round = 0;
+    QBENCHMARK {
+        action->setName(QString("Renamed%1").arg(round++));
+    }
+
+    foreach (Action *action, list) {
+        manager->removeAction(action);
+    }
+}
+
+void
+BenchActionManager::editPreviewParameters_data()
+{
+    QTest::addColumn<int>("actions");
+    QTest::addColumn<int>("parameters");
+
+    QTest::newRow("1x1")    << 1   << 1;
+    QTest::newRow("1x10")   << 1   << 10;
+    QTest::newRow("1x50")   << 1   << 50;
+    QTest::newRow("100x1")  << 100 << 1;
+    QTest::newRow("100x10") << 100 << 10;
+}
+
+void
+BenchActionManager::editPreviewParameters()
+{
+    QFETCH(int, actions);
+    QFETCH(int, parameters);
+
+    QObject parent;
+    QList<PreviewAction *> list = createPreviewActions(actions, parameters, &parent);
+    foreach (PreviewAction *action, list) {
+        manager->addAction(action);
+    }
+
+    PreviewRangeParameter *range;
+    range = qobject_cast<PreviewRangeParameter *>(list.first()->parameters().first());
+    float maximum = 100.0f;
+    QBENCHMARK {
+        range->setMaximumValue(maximum);
+        maximum += 1.0f;
+    }
+
+    foreach (PreviewAction *action, list) {
+        manager->removeAction(action);
+    }
+}
+
+void
+BenchActionManager::addPreviewParameter_data()
+{
+    editPreviewParameters_data();
+}
+
+void
+BenchActionManager::addPreviewParameter()
+{
+    QFETCH(int, actions);
+    QFETCH(int, parameters);
+
+    QObject parent;
+    QList<PreviewAction *> list = createPreviewActions(actions, parameters, &parent);
+    foreach (PreviewAction *action, list) {
+        manager->addAction(action);
+    }
+
+    // adding and removing a parameter rebuilds the parameter menu
+    PreviewAction *action = list.first();
+    PreviewRangeParameter *extra = new PreviewRangeParameter(&parent);
+    QBENCHMARK {
+        action->addParameter(extra);
+        action->removeParameter(extra);
+    }
+
+    foreach (PreviewAction *action, list) {
+        manager->removeAction(action);
+    }
+}
+
+void
+BenchActionManager::triggerAction_data()
+{
+    QTest::addColumn<int>("type");
+    QTest::addColumn<QByteArray>("parameter");
+
+    // the types the manager decodes the activations into
+    QTest::newRow("none")   << (int)Action::None    << QByteArray();
+    QTest::newRow("string") << (int)Action::String  << QByteArray("'value'");
+    QTest::newRow("int")    << (int)Action::Integer << QByteArray("42");
+    QTest::newRow("bool")   << (int)Action::Bool    << QByteArray("true");
+    QTest::newRow("real")   << (int)Action::Real    << QByteArray("4.2");
+}
+
+void
+BenchActionManager::triggerAction()
+{
+    QFETCH(int, type);
+    QFETCH(QByteArray, parameter);
+    QVERIFY(action_group != 0);
+
+    Action action;
+    action.setName("Trigger");
+    action.setParameterType((Action::Type)type);
+
+    // a plain counter instead of a QSignalSpy copying every value
+    int triggered = 0;
+    QObject::connect(&action, &Action::triggered, [&triggered]() { triggered++; });
+    manager->addAction(&action);
+
+    GVariant *value = 0;
+    if (!parameter.isEmpty()) {
+        value = g_variant_parse(NULL, parameter.constData(), NULL, NULL, NULL);
+        QVERIFY(value != 0);
+        g_variant_ref_sink(value);
+    }
+
+    // the whole way of an activation from the bus to the action
+    QElapsedTimer timer;
+    QBENCHMARK {
+        int expected = triggered + 1;
+        timer.start();
+        g_action_group_activate_action(G_ACTION_GROUP(action_group), "Trigger", value);
+        while (triggered < expected) {
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+            if (timer.elapsed() > 5000)
+                QFAIL("The activation did not reach the action.");
+        }
+    }
+
+    if (value != 0)
+        g_variant_unref(value);
+    manager->removeAction(&action);
+}
@@ -0,0 +1,30 @@
+/* This file is part of unity-action-api
+ * Copyright 2013 Canonical Ltd.
+ *
+ * unity-action-api is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * unity-action-api is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranties of
+ * MERCHANTABILITY, SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include "bench_actionmanager.h"
+
+int main(int argc, char *argv[])
+{
+    // the manager needs an event loop for the D-Bus traffic
+    QCoreApplication app(argc, argv);
+
+    BenchActionManager bench_actionmanager;
+
+    return QTest::qExec(&bench_actionmanager, argc, argv);
+}
@@ -160,6 +160,30 @@ TestAction::setParameterType()
     QCOMPARE(spy.count(), 0);
 }
 
+void
+TestAction::propertiesChanged()
+{
+    using unity::action::Action;
+    Action *action = new Action(this);
+
+    QSignalSpy spy(action, SIGNAL(propertiesChanged(unity::action::Action::ChangeMask)));
+
+    action->setName("name");
+    action->setText("text");
+    action->setEnabled(false);
+    action->setParameterType(Action::Integer);
+    QCOMPARE(spy.count(), 4);
+    QCOMPARE(spy.at(0).at(0).value<Action::ChangeMask>(), Action::ChangeMask(Action::NameChange));
+    QCOMPARE(spy.at(1).at(0).value<Action::ChangeMask>(), Action::ChangeMask(Action::TextChange));
+    QCOMPARE(spy.at(2).at(0).value<Action::ChangeMask>(), Action::ChangeMask(Action::EnabledChange));
+    QCOMPARE(spy.at(3).at(0).value<Action::ChangeMask>(), Action::ChangeMask(Action::ParameterTypeChange));
+
+    // no change, no signal
+    spy.clear();
+    action->setText("text");
+    QCOMPARE(spy.count(), 0);
+}
+
 void
 TestAction::trigger()
 {
@@ -425,3 +449,171 @@ TestAction::trigger()
     action->trigger("hello");
     QCOMPARE(spy.count(), 0);
 }
+
+void
+TestAction::typedTrigger()
+{
+    using unity::action::Action;
+    Action *action = new Action(this);
+
+    QSignalSpy spyNone(action, SIGNAL(triggeredNone()));
+    QSignalSpy spyString(action, SIGNAL(triggeredString(QString)));
+    QSignalSpy spyInt(action, SIGNAL(triggeredInt(int)));
+    QSignalSpy spyReal(action, SIGNAL(triggeredReal(double)));
+
+    // trigger() emits the typed signal matching the parameterType
+    action->trigger();
+    QCOMPARE(spyNone.count(), 1);
+    QCOMPARE(spyString.count(), 0);
+    action->triggerNone();
+    QCOMPARE(spyNone.count(), 2);
+
+    action->setParameterType(Action::Integer);
+    action->trigger("-50");
+    QCOMPARE(spyInt.count(), 1);
+    QCOMPARE(spyInt.takeFirst().at(0).toInt(), -50);
+
+    // the typed triggers are checked against the parameterType
+    action->triggerString("foo");
+    QCOMPARE(spyString.count(), 0);
+    action->triggerInt(42);
+    QCOMPARE(spyInt.count(), 1);
+    QCOMPARE(spyInt.takeFirst().at(0).toInt(), 42);
+
+    // triggered() is still emitted when something is connected to it
+    QSignalSpy spy(action, SIGNAL(triggered(QVariant)));
+    action->triggerInt(7);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.takeFirst().at(0).toInt(), 7);
+
+    // the real value keeps its double precision
+    action->setParameterType(Action::Real);
+    action->triggerReal(0.1);
+    QCOMPARE(spyReal.count(), 1);
+    QCOMPARE(spyReal.takeFirst().at(0).toDouble(), 0.1);
+    QCOMPARE(spy.takeFirst().at(0).userType(), (int)QMetaType::Float);
+    // also when the double goes through trigger()
+    action->trigger(QVariant(0.1));
+    QCOMPARE(spyReal.count(), 1);
+    QCOMPARE(spyReal.takeFirst().at(0).toDouble(), 0.1);
+    spy.clear();
+
+    action->setEnabled(false);
+    action->triggerReal(1.0);
+    QCOMPARE(spyReal.count(), 0);
+}
+
+namespace {
+class TriggerThread : public QThread
+{
+public:
+    TriggerThread(unity::action::Action *action, int count)
+        : action(action), count(count) {}
+protected:
+    void run() {
+        for (int i = 0; i < count; i++)
+            action->postTrigger(i);
+    }
+private:
+    unity::action::Action *action;
+    int count;
+};
+}
+
+void
+TestAction::postTrigger()
+{
+    using unity::action::Action;
+    Action *action = new Action(this);
+    action->setParameterType(Action::Integer);
+
+    QSignalSpy spy(action, SIGNAL(triggeredInt(int)));
+
+    // posted triggers are handled on the owning thread
+    action->postTrigger(1);
+    action->postTrigger(2);
+    QCOMPARE(spy.count(), 0);
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(0).toInt(), 1);
+    QCOMPARE(spy.at(1).at(0).toInt(), 2);
+    spy.clear();
+
+    QList<TriggerThread *> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.append(new TriggerThread(action, 1000));
+    }
+    foreach (TriggerThread *thread, threads) {
+        thread->start();
+    }
+    foreach (TriggerThread *thread, threads) {
+        thread->wait();
+    }
+    QTRY_COMPARE(spy.count(), 4000);
+    qDeleteAll(threads);
+}
+
+void
+TestAction::activationPolicy()
+{
+    using unity::action::Action;
+    Action *action = new Action(this);
+    action->setParameterType(Action::Integer);
+    QSignalSpy spy(action, SIGNAL(triggeredInt(int)));
+
+    // debounce: only the last value of the burst goes through
+    action->setActivationPolicy(Action::Debounce);
+    action->setActivationInterval(50);
+    for (int i = 0; i < 10; i++) {
+        action->triggerInt(i);
+    }
+    QCOMPARE(spy.count(), 0);
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.takeFirst().at(0).toInt(), 9);
+    QCOMPARE(action->coalescedActivations(), 9);
+    QCOMPARE(action->droppedActivations(), 0);
+
+    // throttle without a backlog drops what comes in too fast
+    action->resetActivationCounters();
+    action->setActivationPolicy(Action::Throttle);
+    action->setActivationInterval(100);
+    for (int i = 0; i < 5; i++) {
+        action->trigger(i);
+    }
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(action->droppedActivations(), 4);
+    QTest::qWait(150);
+    QCOMPARE(spy.count(), 1);
+
+    // a backlog of two keeps the oldest ones by default
+    spy.clear();
+    action->resetActivationCounters();
+    action->setActivationBacklog(2);
+    action->setActivationInterval(20);
+    for (int i = 0; i < 5; i++) {
+        action->triggerInt(i);
+    }
+    QCOMPARE(action->droppedActivations(), 2);
+    QTRY_COMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(1).at(0).toInt(), 1);
+    QCOMPARE(spy.at(2).at(0).toInt(), 2);
+
+    // or the newest ones
+    QTest::qWait(50);
+    spy.clear();
+    action->resetActivationCounters();
+    action->setOverflowPolicy(Action::DropOldest);
+    for (int i = 0; i < 5; i++) {
+        action->triggerInt(i);
+    }
+    QCOMPARE(action->droppedActivations(), 2);
+    QTRY_COMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(1).at(0).toInt(), 3);
+    QCOMPARE(spy.at(2).at(0).toInt(), 4);
+
+    // switching back delivers what is held back
+    action->triggerInt(10);
+    action->triggerInt(11);
+    action->setActivationPolicy(Action::Unrestricted);
+    QCOMPARE(spy.count(), 5);
+    QCOMPARE(spy.at(4).at(0).toInt(), 11);
+}
@@ -28,7 +28,11 @@ private slots:
     void setKeywords();
     void setEnabled();
     void setParameterType();
+    void propertiesChanged();
 
     void trigger();
+    void typedTrigger();
+    void postTrigger();
+    void activationPolicy();
 };
 
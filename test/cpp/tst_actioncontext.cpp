@@ -76,6 +76,129 @@ TestActionContext::actionOperations()
             ctx->actions().contains(action2));
 }
 
+void
+TestActionContext::bulkOperations()
+{
+    ActionContext *ctx = new ActionContext(this);
+    QList<Action *> actions;
+    for (int i = 0; i < 5; i++) {
+        actions.append(new Action(this));
+    }
+
+    QSignalSpy spy(ctx, SIGNAL(actionsChanged()));
+    ctx->addActions(actions);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(ctx->actions().count(), 5);
+
+    // nothing new, no signal
+    ctx->addActions(actions.mid(0, 2));
+    QCOMPARE(spy.count(), 1);
+
+    ctx->removeActions(actions.mid(0, 2));
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(ctx->actions().count(), 3);
+    QVERIFY(!ctx->actions().contains(actions[0]) &&
+            !ctx->actions().contains(actions[1]));
+
+    ctx->removeActions(actions.mid(0, 2));
+    QCOMPARE(spy.count(), 2);
+
+    ctx->clear();
+    QCOMPARE(spy.count(), 3);
+    QVERIFY(ctx->actions().isEmpty());
+    ctx->clear();
+    QCOMPARE(spy.count(), 3);
+
+    // the removed actions are no longer tracked for deletion
+    ctx->addActions(actions.mid(0, 1));
+    ctx->clear();
+    spy.clear();
+    delete actions[0];
+    QCOMPARE(spy.count(), 0);
+
+    // the added ones are
+    ctx->addActions(actions.mid(1));
+    spy.clear();
+    delete actions[1];
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(ctx->actions().count(), 3);
+}
+
+void
+TestActionContext::changeSignals()
+{
+    ActionContext *ctx = new ActionContext(this);
+    Action *action1 = new Action(this);
+    Action *action2 = new Action(this);
+    Action *action3 = new Action();
+
+    QSignalSpy spyAdded(ctx, SIGNAL(actionsAdded(QList<unity::action::Action*>)));
+    QSignalSpy spyRemoved(ctx, SIGNAL(actionsRemoved(QList<unity::action::Action*>)));
+    quint64 generation = ctx->generation();
+
+    ctx->addAction(action1);
+    QCOMPARE(spyAdded.count(), 1);
+    QCOMPARE(spyAdded.takeFirst().at(0).value<QList<Action *> >(), QList<Action *>() << action1);
+    QVERIFY(ctx->generation() > generation);
+    generation = ctx->generation();
+
+    // no change, no signals
+    ctx->addAction(action1);
+    QCOMPARE(spyAdded.count(), 0);
+    QCOMPARE(ctx->generation(), generation);
+
+    ctx->addActions(QList<Action *>() << action1 << action2 << action3);
+    QCOMPARE(spyAdded.count(), 1);
+    QCOMPARE(spyAdded.takeFirst().at(0).value<QList<Action *> >(), QList<Action *>() << action2 << action3);
+    QVERIFY(ctx->generation() > generation);
+
+    ctx->removeActions(QList<Action *>() << action1);
+    QCOMPARE(spyRemoved.count(), 1);
+    QCOMPARE(spyRemoved.takeFirst().at(0).value<QList<Action *> >(), QList<Action *>() << action1);
+
+    delete action3;
+    QCOMPARE(spyRemoved.count(), 1);
+    QCOMPARE(spyRemoved.takeFirst().at(0).value<QList<Action *> >().count(), 1);
+
+    ctx->clear();
+    QCOMPARE(spyRemoved.count(), 1);
+    QCOMPARE(spyRemoved.takeFirst().at(0).value<QList<Action *> >(), QList<Action *>() << action2);
+    QCOMPARE(spyAdded.count(), 0);
+}
+
+void
+TestActionContext::constAccessors()
+{
+    ActionContext *ctx = new ActionContext(this);
+    Action *action1 = new Action(this);
+    Action *action2 = new Action(this);
+
+    QCOMPARE(ctx->count(), 0);
+    QVERIFY(!ctx->contains(action1));
+
+    ctx->addAction(action1);
+    ctx->addAction(action2);
+    QCOMPARE(ctx->count(), 2);
+    QVERIFY(ctx->contains(action1));
+    QCOMPARE(ctx->constActions(), ctx->actions());
+
+    QSet<Action *> visited;
+    ctx->forEachAction([&visited](Action *action) { visited.insert(action); });
+    QCOMPARE(visited, ctx->actions());
+
+    ctx->removeAction(action1);
+    QCOMPARE(ctx->count(), 1);
+    QVERIFY(!ctx->contains(action1));
+    QVERIFY(ctx->contains(action2));
+
+    ActionManager manager;
+    QCOMPARE(manager.actionCount(), 0);
+    QVERIFY(!manager.containsAction(action2));
+    QVERIFY(manager.constLocalContexts().isEmpty());
+    manager.addLocalContext(ctx);
+    QCOMPARE(manager.constLocalContexts(), manager.localContexts());
+}
+
 void
 TestActionContext::deletedActions()
 {
@@ -23,6 +23,9 @@ class TestActionContext : public QObject
 private slots:
     void setActive();
     void actionOperations();
+    void bulkOperations();
+    void changeSignals();
+    void constAccessors();
 
     void deletedActions();
 };
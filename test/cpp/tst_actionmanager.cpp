@@ -31,6 +31,36 @@
 
 using namespace unity::action;
 
+// the parameter menu the manager publishes to the HUD for the action
+static GMenuModel *
+parameterMenu(ActionManager *manager, PreviewAction *action)
+{
+    QObject *internals = manager->findChild<QObject *>("unity-action-manager-private",
+                                                       Qt::FindDirectChildrenOnly);
+    void *menu = 0;
+    if (internals == 0 ||
+        !QMetaObject::invokeMethod(internals, "parameterMenu", Qt::DirectConnection,
+                                   Q_RETURN_ARG(void *, menu),
+                                   Q_ARG(QObject *, action))) {
+        return 0;
+    }
+    return G_MENU_MODEL(menu);
+}
+
+static void
+menu_items_changed(GMenuModel *model,
+                   gint        position,
+                   gint        removed,
+                   gint        added,
+                   gpointer    user_data)
+{
+    Q_UNUSED(model);
+    Q_UNUSED(position);
+    Q_UNUSED(removed);
+    Q_UNUSED(added);
+    (*(int *)user_data)++;
+}
+
 void
 TestActionManager::initTestCase()
 {
@@ -371,7 +401,7 @@ TestActionManager::deletedAction()
 
     // delete action4 and action5 indirectly by destroying ctx2
     delete ctx2;
-    QCOMPARE(spy.count(), 5); // actionsChanged() gets called multiple times (once per each action in a context)
+    QCOMPARE(spy.count(), 4); // actionsChanged() gets called once for all the actions of a context
     QVERIFY(!manager->actions().contains(action4));
     QVERIFY(!manager->actions().contains(action5));
     QCOMPARE(manager->actions().count(), 1);
@@ -534,6 +564,282 @@ TestActionManager::localContextOverridesGlobalContext()
 
 }
 
+void
+TestActionManager::batchUpdates()
+{
+    /* Changes made between beginUpdate() and endUpdate()
+     * must be applied only when the batch ends.
+     */
+
+    ActionContext *ctx1 = new ActionContext(manager);
+    Action *action1 = new Action(manager);
+    Action *action2 = new Action(manager);
+    Action *action3 = new Action(manager);
+
+    QSignalSpy spy(manager, SIGNAL(actionsChanged()));
+    QSignalSpy spy1(action1, SIGNAL(triggered(QVariant)));
+    QSignalSpy spy2(action2, SIGNAL(triggered(QVariant)));
+
+    manager->beginUpdate();
+    manager->addAction(action1);
+    action1->setName("BatchedGlobal");
+
+    manager->beginUpdate(); // nested
+    ctx1->addAction(action2);
+    ctx1->addAction(action3);
+    manager->addLocalContext(ctx1);
+    ctx1->setActive(true);
+    action2->setName("BatchedLocal");
+    manager->endUpdate();
+
+    // the context drops the deleted action before the manager ever sees it
+    delete action3;
+    action3 = 0;
+
+    QCOMPARE(spy.count(), 0);
+    QCOMPARE(manager->actions().count(), 1);
+    manager->endUpdate();
+    // once for the whole batch
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(manager->actions().count(), 3);
+    QVERIFY(manager->actions().contains(action1) &&
+            manager->actions().contains(action2));
+
+    QTest::qWait(100);
+    g_action_group_activate_action(G_ACTION_GROUP(action_group), "BatchedGlobal", NULL);
+    spy1.wait();
+    g_action_group_activate_action(G_ACTION_GROUP(action_group), "BatchedLocal", NULL);
+    spy2.wait();
+    QCOMPARE(spy1.count(), 1);
+    QCOMPARE(spy2.count(), 1);
+
+    spy.clear();
+    manager->beginUpdate();
+    manager->removeAction(action1);
+    // deleting an action known to the manager inside a batch
+    // must not leave a dangling pointer behind
+    delete action2;
+    action2 = 0;
+    QCOMPARE(manager->actions().count(), 2);
+    manager->endUpdate();
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(manager->actions().count(), 1);
+
+    manager->removeLocalContext(ctx1);
+}
+
+void
+TestActionManager::deferredUpdates()
+{
+    /* In the deferred mode the changes are reconciled
+     * once when the control returns to the event loop.
+     */
+
+    ActionContext *ctx1 = new ActionContext(manager);
+    Action *action1 = new Action(manager);
+    Action *action2 = new Action(manager);
+    Action *action3 = new Action(manager);
+
+    QSignalSpy spy(manager, SIGNAL(actionsChanged()));
+    QSignalSpy spy3(action3, SIGNAL(triggered(QVariant)));
+
+    QSignalSpy deferredspy(manager, SIGNAL(deferredUpdatesChanged(bool)));
+    manager->setDeferredUpdates(true);
+    manager->setDeferredUpdates(true);
+    QCOMPARE(deferredspy.count(), 1);
+    QVERIFY(manager->deferredUpdates());
+
+    manager->addAction(action1);
+    manager->addAction(action2);
+    ctx1->addAction(action3);
+    manager->addLocalContext(ctx1);
+    ctx1->setActive(true);
+    action3->setName("DeferredLocal");
+    QCOMPARE(spy.count(), 0);
+
+    QTest::qWait(10);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(manager->actions().count(), 4);
+
+    QTest::qWait(100);
+    g_action_group_activate_action(G_ACTION_GROUP(action_group), "DeferredLocal", NULL);
+    spy3.wait();
+    QCOMPARE(spy3.count(), 1);
+
+    // leaving the deferred mode applies the pending changes immediately
+    spy.clear();
+    manager->removeAction(action1);
+    manager->removeAction(action2);
+    QCOMPARE(spy.count(), 0);
+    manager->setDeferredUpdates(false);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(manager->actions().count(), 2);
+
+    manager->removeLocalContext(ctx1);
+}
+
+void
+TestActionManager::hudDescriptionRetirement()
+{
+    /* Renaming and removing actions leaves hidden descriptions behind
+     * in the HUD contexts. Churn enough of them to make the manager
+     * rebuild the publishers and check the actions still work.
+     */
+
+    ActionContext *ctx1 = new ActionContext(manager);
+    Action *action1 = new Action(manager);
+    Action *action2 = new Action(manager);
+    QSignalSpy spy1(action1, SIGNAL(triggered(QVariant)));
+
+    manager->addAction(action1);
+    ctx1->addAction(action2);
+    manager->addLocalContext(ctx1);
+    ctx1->setActive(true);
+
+    int descriptionAdds = 0;
+    for (int op = 0; op < ActionManager::OperationCount; op++) {
+        descriptionAdds -= manager->trafficCount((ActionManager::Operation)op,
+                                                 ActionManager::DescriptionAdd);
+    }
+
+    for (int i = 0; i < 200; i++) {
+        action1->setName(QString("Retired%1").arg(i));
+        ctx1->removeAction(action2);
+        ctx1->addAction(action2);
+    }
+    QCOMPARE(manager->actions().count(), 3);
+
+    for (int op = 0; op < ActionManager::OperationCount; op++) {
+        descriptionAdds += manager->trafficCount((ActionManager::Operation)op,
+                                                 ActionManager::DescriptionAdd);
+    }
+    /* Each round adds the renamed description to both of the contexts
+     * and action2 again to ctx1. Anything beyond that are the live
+     * descriptions copied to the rebuilt publishers, which only happens
+     * once per UNITY_ACTION_HUD_TOMBSTONE_LIMIT hidden descriptions.
+     */
+    int rebuildAdds = descriptionAdds - 200 * 3;
+    QVERIFY(rebuildAdds > 0);
+    QVERIFY(rebuildAdds < 200);
+
+    QTest::qWait(100);
+    g_action_group_activate_action(G_ACTION_GROUP(action_group), "Retired199", NULL);
+    spy1.wait();
+    QCOMPARE(spy1.count(), 1);
+
+    manager->removeLocalContext(ctx1);
+    manager->removeAction(action1);
+    delete ctx1;
+    delete action1;
+    delete action2;
+}
+
+void
+TestActionManager::trafficBounds()
+{
+    /* Upper bounds for the D-Bus traffic the common operations cause.
+     * A regression in the message volume makes these fail.
+     */
+
+    ActionContext *ctx1 = new ActionContext(manager);
+    ActionContext *ctx2 = new ActionContext(manager);
+    QList<Action *> globals;
+    for (int i = 0; i < 10; i++) {
+        Action *action = new Action(manager);
+        action->setName(QString("TrafficGlobal%1").arg(i));
+        globals.append(action);
+
+        // the same names in both of the local contexts
+        action = new Action(ctx1);
+        action->setName(QString("TrafficLocal%1").arg(i));
+        ctx1->addAction(action);
+        action = new Action(ctx2);
+        action->setName(QString("TrafficLocal%1").arg(i));
+        ctx2->addAction(action);
+    }
+
+    manager->resetTrafficCounters();
+    manager->beginUpdate();
+    foreach (Action *action, globals) {
+        manager->addAction(action);
+    }
+    manager->endUpdate();
+    QCOMPARE(manager->trafficCount(ActionManager::FlushOperation, ActionManager::ActionGroupInsert), 10);
+    QCOMPARE(manager->trafficCount(ActionManager::FlushOperation, ActionManager::ActionGroupRemove), 0);
+    QCOMPARE(manager->trafficCount(ActionManager::FlushOperation, ActionManager::DescriptionAdd), 10);
+    QCOMPARE(manager->trafficCount(ActionManager::ActionOperation, ActionManager::ActionGroupInsert), 0);
+
+    // inactive local contexts are only published to the HUD
+    manager->resetTrafficCounters();
+    manager->addLocalContext(ctx1);
+    manager->addLocalContext(ctx2);
+    QCOMPARE(manager->trafficCount(ActionManager::ActionOperation, ActionManager::ActionGroupInsert), 0);
+    QVERIFY(manager->trafficCount(ActionManager::ActionOperation, ActionManager::DescriptionAdd) <= 2 * 21);
+
+    manager->resetTrafficCounters();
+    ctx1->setActive(true);
+    QVERIFY(manager->trafficCount(ActionManager::ContextSwitchOperation, ActionManager::ActionGroupInsert) <= 10);
+    QCOMPARE(manager->trafficCount(ActionManager::ContextSwitchOperation, ActionManager::ActionGroupRemove), 0);
+    QCOMPARE(manager->trafficCount(ActionManager::ContextSwitchOperation, ActionManager::DescriptionAdd), 0);
+
+    manager->resetTrafficCounters();
+    ctx2->setActive(true);
+    QVERIFY(manager->trafficCount(ActionManager::ContextSwitchOperation, ActionManager::ActionGroupInsert) <= 10);
+    QCOMPARE(manager->trafficCount(ActionManager::ContextSwitchOperation, ActionManager::ActionGroupRemove), 0);
+
+    manager->resetTrafficCounters();
+    ctx2->setActive(false);
+    QCOMPARE(manager->trafficCount(ActionManager::ContextSwitchOperation, ActionManager::ActionGroupInsert), 0);
+    QVERIFY(manager->trafficCount(ActionManager::ContextSwitchOperation, ActionManager::ActionGroupRemove) <= 10);
+
+    // unchanged values cause no traffic at all
+    manager->resetTrafficCounters();
+    globals[0]->setText("Traffic");
+    globals[0]->setText("Traffic");
+    globals[0]->setEnabled(false);
+    globals[0]->setEnabled(false);
+    QCOMPARE(manager->trafficCount(ActionManager::PropertyOperation, ActionManager::AttributeSet), 1);
+    QCOMPARE(manager->trafficCount(ActionManager::PropertyOperation, ActionManager::EnabledChange), 1);
+    QCOMPARE(manager->trafficCount(ActionManager::PropertyOperation, ActionManager::ActionGroupInsert), 0);
+
+    // an action removed from one of its contexts gets its label back when re-added
+    Action *shared = new Action(ctx1);
+    shared->setName("TrafficShared");
+    shared->setText("Shared");
+    manager->beginUpdate();
+    ctx1->addAction(shared);
+    ctx2->addAction(shared);
+    manager->endUpdate();
+    manager->resetTrafficCounters();
+    manager->beginUpdate();
+    ctx1->removeAction(shared);
+    manager->endUpdate();
+    manager->beginUpdate();
+    ctx1->addAction(shared);
+    manager->endUpdate();
+    QCOMPARE(manager->trafficCount(ActionManager::FlushOperation, ActionManager::AttributeSet), 2);
+    ctx1->removeAction(shared);
+    ctx2->removeAction(shared);
+    delete shared;
+
+    // a global action is part of all the three HUD contexts
+    manager->resetTrafficCounters();
+    globals[0]->setName("TrafficRenamed");
+    QVERIFY(manager->trafficCount(ActionManager::PropertyOperation, ActionManager::ActionGroupInsert) <= 1);
+    QVERIFY(manager->trafficCount(ActionManager::PropertyOperation, ActionManager::ActionGroupRemove) <= 1);
+    QVERIFY(manager->trafficCount(ActionManager::PropertyOperation, ActionManager::DescriptionAdd) <= 3);
+    QVERIFY(manager->trafficCount(ActionManager::PropertyOperation, ActionManager::AttributeSet) <= 1);
+
+    manager->removeLocalContext(ctx1);
+    manager->removeLocalContext(ctx2);
+    foreach (Action *action, globals) {
+        manager->removeAction(action);
+        delete action;
+    }
+    delete ctx1;
+    delete ctx2;
+}
+
 void
 TestActionManager::previewParameters()
 {
@@ -869,9 +1175,57 @@ TestActionManager::previewParameters()
 
     // update some parameters
     action1->setCommitLabel("Do Stuff");
+    int menuUpdates = manager->trafficCount(ActionManager::ParameterOperation,
+                                            ActionManager::AttributeSet);
     param1->setMinimumValue(-50.0f);
     param1->setMaximumValue(50.0f);
+    // the menu item is swapped in place, the description is left alone
+    QCOMPARE(manager->trafficCount(ActionManager::ParameterOperation,
+                                   ActionManager::AttributeSet) - menuUpdates, 0);
+
+    // relabeling a parameter replaces only its own item, in one change
+    GMenuModel *menu = parameterMenu(manager, action2);
+    QVERIFY(menu != 0);
+    QCOMPARE(g_menu_model_get_n_items(menu), 2);
+    int itemsChanged = 0;
+    gulong handler = g_signal_connect(menu, "items-changed",
+                                      G_CALLBACK(menu_items_changed), &itemsChanged);
+    param3->setText("Relabeled");
+    QCOMPARE(itemsChanged, 1);
+    QCOMPARE(g_menu_model_get_n_items(menu), 2);
+    gchar *label = NULL;
+    QVERIFY(g_menu_model_get_item_attribute(menu, 1, G_MENU_ATTRIBUTE_LABEL, "s", &label));
+    QCOMPARE(label, "Relabeled");
+    g_free(label);
+    g_signal_handler_disconnect(menu, handler);
+
+    // the value is published as the state of the parameter gaction
+    int stateChanges = manager->trafficCount(ActionManager::ParameterOperation,
+                                             ActionManager::StateChange);
     param1->setValue(25.0f);
+    QCOMPARE(manager->trafficCount(ActionManager::ParameterOperation,
+                                   ActionManager::StateChange) - stateChanges, 1);
+    QTest::qWait(100);
+    GVariant *state = g_action_group_get_action_state(G_ACTION_GROUP(action_group),
+                                                      "unity-action-range-param-0");
+    QVERIFY(state != 0);
+    QCOMPARE(g_variant_get_double(state), 25.0);
+    g_variant_unref(state);
+
+    // changes within the epsilon are not published
+    param1->setValueEpsilon(1.0f);
+    param1->setValue(25.5f);
+    QCOMPARE(manager->trafficCount(ActionManager::ParameterOperation,
+                                   ActionManager::StateChange) - stateChanges, 1);
+    param1->setValueEpsilon(0.0f);
+
+    // the HUD can change the value through the state as well
+    g_action_group_change_action_state(G_ACTION_GROUP(action_group),
+                                       "unity-action-range-param-0",
+                                       g_variant_new_double(30.0f));
+    QTRY_VERIFY(qFuzzyCompare(param1->value(), 30.0f));
+    QCOMPARE(manager->trafficCount(ActionManager::ParameterOperation,
+                                   ActionManager::StateChange) - stateChanges, 2);
     /*! \todo there is actually no way of verifying these right now without accessing them from
      *        HUD menumodels or creating a HUD query..
      */
@@ -890,3 +1244,111 @@ TestActionManager::previewParameters()
     manager->removeAction(action1);
     manager->removeLocalContext(ctx1);
 }
+
+void
+TestActionManager::shutdownFlush()
+{
+    /* only one manager can export the actions on the bus,
+     * so the one of the test case is replaced for a while.
+     */
+    delete manager;
+    QVERIFY(ActionManager::shutdownFlushTime() >= 0);
+
+    qputenv("UNITY_ACTION_FLUSH_TIMEOUT", "5000");
+    manager = new ActionManager(this);
+    Action *action = new Action(manager);
+    action->setName("Flushed");
+    manager->addAction(action);
+    delete manager;
+    qunsetenv("UNITY_ACTION_FLUSH_TIMEOUT");
+
+    // the flush finished within the deadline
+    QVERIFY(ActionManager::shutdownFlushTime() >= 0);
+    QVERIFY(ActionManager::shutdownFlushTime() < 5000 * 1000);
+
+    // without the variable the flush is bounded by the default deadline
+    manager = new ActionManager(this);
+    action = new Action(manager);
+    action->setName("Flushed");
+    manager->addAction(action);
+    delete manager;
+    QVERIFY(ActionManager::shutdownFlushTime() >= 0);
+    QVERIFY(ActionManager::shutdownFlushTime() < 2000 * 1000);
+
+    manager = new ActionManager(this);
+}
+
+void
+TestActionManager::bulkChangeSignals()
+{
+    ActionContext *gctx = manager->globalContext();
+    Action *action1 = new Action(manager);
+    Action *action2 = new Action(manager);
+    Action *action3 = new Action(manager);
+    QList<Action *> actions;
+    actions << action1 << action2 << action3;
+
+    QSignalSpy spy(manager, SIGNAL(actionsChanged()));
+    QSignalSpy spyAdded(manager, SIGNAL(actionsAdded(QList<unity::action::Action*>)));
+    QSignalSpy spyRemoved(manager, SIGNAL(actionsRemoved(QList<unity::action::Action*>)));
+
+    // a bulk change is signalled once with all of the actions
+    gctx->addActions(actions);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spyAdded.count(), 1);
+    QCOMPARE(spyAdded.takeFirst().at(0).value<QList<Action *> >().toSet(), actions.toSet());
+    QCOMPARE(spyRemoved.count(), 0);
+
+    spy.clear();
+    gctx->removeActions(actions);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spyRemoved.count(), 1);
+    QCOMPARE(spyRemoved.takeFirst().at(0).value<QList<Action *> >().toSet(), actions.toSet());
+
+    // an action added and removed within a batch is not signalled at all
+    spy.clear();
+    manager->beginUpdate();
+    manager->addAction(action1);
+    manager->addAction(action2);
+    manager->addAction(action3);
+    delete action3;
+    manager->endUpdate();
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spyAdded.count(), 1);
+    QCOMPARE(spyAdded.takeFirst().at(0).value<QList<Action *> >().toSet(),
+             (QList<Action *>() << action1 << action2).toSet());
+    QCOMPARE(spyRemoved.count(), 0);
+
+    manager->removeAction(action1);
+    manager->removeAction(action2);
+}
+
+void
+TestActionManager::asyncBus()
+{
+    // see shutdownFlush() for replacing the manager of the test case
+    delete manager;
+    qputenv("UNITY_ACTION_ASYNC_BUS", "1");
+    manager = new ActionManager(this);
+    qunsetenv("UNITY_ACTION_ASYNC_BUS");
+
+    // the session bus is not there before the event loop runs
+    Action *action = new Action(manager);
+    action->setName("AsyncBus");
+    QSignalSpy spy(action, SIGNAL(triggered(QVariant)));
+    manager->addAction(action);
+    QCOMPARE(manager->trafficCount(ActionManager::ActionOperation,
+                                   ActionManager::DescriptionAdd), 0);
+
+    // once the bus arrives the quit action and the new one get published
+    QTRY_VERIFY(manager->trafficCount(ActionManager::ActionOperation,
+                                      ActionManager::DescriptionAdd) >= 2);
+
+    // and exported
+    QTest::qWait(100);
+    g_action_group_activate_action(G_ACTION_GROUP(action_group), "AsyncBus", NULL);
+    spy.wait();
+    QCOMPARE(spy.count(), 1);
+
+    manager->removeAction(action);
+}
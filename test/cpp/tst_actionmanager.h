@@ -41,8 +41,17 @@ private slots:
     void actionInMultipleContext();
     void localContextOverridesGlobalContext();
 
+    void batchUpdates();
+    void bulkChangeSignals();
+    void deferredUpdates();
+    void hudDescriptionRetirement();
+    void trafficBounds();
+
     void previewParameters();
 
+    void shutdownFlush();
+    void asyncBus();
+
     // do this last as it creates a new globalContext in the effort of
     // preventing a crash, but anyway the functionality of the ActionManager
     // is more or less undefined after this.
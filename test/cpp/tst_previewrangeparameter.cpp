@@ -118,3 +118,51 @@ TestPreviewRangeParameter::setMaximumValue()
     param->setMaximumValue(99);
     QVERIFY(qFuzzyCompare(param->minimumValue(), param->maximumValue()));
 }
+
+void
+TestPreviewRangeParameter::deliveryPolicy()
+{
+    using unity::action::PreviewRangeParameter;
+    PreviewRangeParameter *param;
+    param = new PreviewRangeParameter(this);
+    QCOMPARE(param->deliveryPolicy(), PreviewRangeParameter::Immediate);
+
+    QSignalSpy spy(param, SIGNAL(valueChanged(float)));
+    param->deliverValue(10);
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(!param->hasPendingValue());
+
+    // latest value wins on the next event loop iteration
+    spy.clear();
+    param->setDeliveryPolicy(PreviewRangeParameter::Coalesced);
+    param->deliverValue(20);
+    param->deliverValue(30);
+    param->deliverValue(40);
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(param->hasPendingValue());
+    QTRY_COMPARE(spy.count(), 1);
+    QVERIFY(qFuzzyCompare(spy.takeFirst().at(0).toFloat(), 40.0f));
+
+    // the first value goes out right away, the rest is held back
+    param->setDeliveryPolicy(PreviewRangeParameter::RateLimited);
+    param->setMaximumRate(5);
+    QTest::qWait(250);
+    param->deliverValue(50);
+    param->deliverValue(60);
+    param->deliverValue(70);
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(param->hasPendingValue());
+
+    // an explicit flush delivers the exact final value
+    param->flushPendingValue();
+    QCOMPARE(spy.count(), 2);
+    QVERIFY(qFuzzyCompare(spy.at(1).at(0).toFloat(), 70.0f));
+    QVERIFY(!param->hasPendingValue());
+
+    // the application setting the value drops the pending one
+    param->deliverValue(80);
+    param->setValue(90);
+    QVERIFY(!param->hasPendingValue());
+    QTest::qWait(300);
+    QVERIFY(qFuzzyCompare(param->value(), 90.0f));
+}
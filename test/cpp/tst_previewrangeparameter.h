@@ -25,5 +25,6 @@ private slots:
     void setValue();
     void setMinimumValue();
     void setMaximumValue();
+    void deliveryPolicy();
 };
 